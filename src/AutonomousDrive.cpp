@@ -22,11 +22,19 @@
  */
 
 #include <EncoderMotor.h>
+#include <CarMotorControl.h>
+#include <MotorInfoStorage.h>
 #include <HCSR04.h>
 
 #include "AutonomousDrive.h"
 #include "RobotCar.h"
 #include "RobotCarGui.h"
+#include "TimeToCollision.h"
+#include "SpeedGovernor.h"
+#include "DistanceFilter.h"
+#include "Exploration.h"
+#include "ScanMatching.h"
+#include "HeadingFusion.h"
 
 #include <stdlib.h> // for dtostrf()
 
@@ -48,7 +56,10 @@ uint8_t sCentimeterPerScan = CENTIMETER_PER_RIDE;
 
 void initUSServo() {
     USDistanceServo.attach(US_SERVO_PIN);
+    readUSServoModelFromEeprom();
     US_ServoWriteAndDelay(90);
+    resetDistanceHistory();
+    invalidateScanCache();
 }
 /*
  * sets also sLastServoAngleInDegrees to enable optimized servo movement and delays
@@ -75,24 +86,604 @@ void US_ServoWriteAndDelay(uint8_t aValueDegrees, bool doDelay) {
         // Synchronize and check for user input before doing delay
         rightEncoderMotor.synchronizeMotor(&leftEncoderMotor, MOTOR_DEFAULT_SYNCHRONIZE_INTERVAL_MILLIS);
         loopGUI();
+        updateHeadingFusion();
         // Datasheet says: SG90 Micro Servo needs 100 millis per 60 degrees angle => 300 ms per 180
         // I measured: SG90 Micro Servo needs 400 per 180 degrees and 400 per 2*90 degree, but 540 millis per 9*20 degree
         // 60-80 ms for 20 degrees
+        // The remaining time is taken from the motion model of the servo, which can be learned by calibrateUSServo().
+        measureFixedUSSensorsWhileServoMoves();
+        delay(USDistanceServo.getMillisUntilSettled());
+    }
+}
+
+/*
+ * Time from start of servo movement from aStartDegrees to SERVO_CALIBRATION_TARGET_DEGREES until the target is seen.
+ * Returns 0 if the target was seen at the start position or not seen at all.
+ */
+static uint16_t measureUSServoMoveMillis(uint8_t aStartDegrees, unsigned int aTargetCentimeter) {
+    unsigned int tTimeoutCentimeter = aTargetCentimeter + (2 * SERVO_CALIBRATION_TOLERANCE_CENTIMETER);
+    US_ServoWriteAndDelay(aStartDegrees);
+    // do not rely on the actual model here
+    delay(500);
+    unsigned int tDistance = getUSDistanceAsCentiMeterWithCentimeterTimeout(tTimeoutCentimeter);
+    if (abs((int) tDistance - (int) aTargetCentimeter) <= SERVO_CALIBRATION_TOLERANCE_CENTIMETER) {
+        return 0;
+    }
+
+    US_ServoWriteAndDelay(SERVO_CALIBRATION_TARGET_DEGREES);
+    unsigned long tStartMillis = millis();
+    do {
+        delay(2); // to avoid receiving the echo of the last ping
+        tDistance = getUSDistanceAsCentiMeterWithCentimeterTimeout(tTimeoutCentimeter);
+        if (abs((int) tDistance - (int) aTargetCentimeter) <= SERVO_CALIBRATION_TOLERANCE_CENTIMETER) {
+            return millis() - tStartMillis;
+        }
+    } while (millis() - tStartMillis < 1000);
+    return 0;
+}
+
+/*
+ * Learn speed and settle time of the US servo.
+ * Requires a narrow target e.g. a can in front of the car at 20 to 60 cm and free space at the sides.
+ * The servo moves to the target from 2 start angles and the time until the US reading shows the target distance is measured.
+ * The beam sees the target US_BEAM_HALF_ANGLE_DEGREES before it is reached, which is the same for both moves,
+ * so the difference of both times gives the speed. The remaining start latency is taken as settle time.
+ * Returns false if no target is found or the values are not plausible.
+ */
+bool calibrateUSServo() {
+    US_ServoWriteAndDelay(SERVO_CALIBRATION_TARGET_DEGREES);
+    delay(500);
+    unsigned int tTargetCentimeter = getUSDistanceAsCentiMeterWithCentimeterTimeout(US_TIMEOUT_CENTIMETER);
+    if (tTargetCentimeter < 20 || tTargetCentimeter > 60) {
+        return false;
+    }
+
+    uint16_t tShortMoveMillis = 0;
+    uint16_t tLongMoveMillis = 0;
+    for (uint8_t i = 0; i < SERVO_CALIBRATION_REPEATS; ++i) {
+        uint16_t tShortMillis = measureUSServoMoveMillis(SERVO_CALIBRATION_TARGET_DEGREES - SERVO_CALIBRATION_SHORT_MOVE_DEGREES,
+                tTargetCentimeter);
+        uint16_t tLongMillis = measureUSServoMoveMillis(SERVO_CALIBRATION_TARGET_DEGREES - SERVO_CALIBRATION_LONG_MOVE_DEGREES,
+                tTargetCentimeter);
+        if (tShortMillis == 0 || tLongMillis == 0) {
+            return false;
+        }
+        tShortMoveMillis += tShortMillis;
+        tLongMoveMillis += tLongMillis;
+    }
+    if (tLongMoveMillis <= tShortMoveMillis) {
+        return false;
+    }
+
+    unsigned long tMicrosPerDegree = ((tLongMoveMillis - tShortMoveMillis) * 1000L)
+            / ((SERVO_CALIBRATION_LONG_MOVE_DEGREES - SERVO_CALIBRATION_SHORT_MOVE_DEGREES) * SERVO_CALIBRATION_REPEATS);
+    if (tMicrosPerDegree < SERVO_MIN_MICROS_PER_DEGREE || tMicrosPerDegree > SERVO_MAX_MICROS_PER_DEGREE) {
+        return false;
+    }
+    long tSettleMillis = (tShortMoveMillis / SERVO_CALIBRATION_REPEATS)
+            - (((SERVO_CALIBRATION_SHORT_MOVE_DEGREES - US_BEAM_HALF_ANGLE_DEGREES) * tMicrosPerDegree) / 1000);
+    if (tSettleMillis < 0) {
+        tSettleMillis = 0;
+    } else if (tSettleMillis > 255) {
+        tSettleMillis = 255;
+    }
+    USDistanceServo.setMotionModel(tMicrosPerDegree, tSettleMillis);
+
+    EepromServoModelStruct tEepromServoModel;
+    tEepromServoModel.MicrosPerDegree = tMicrosPerDegree;
+    tEepromServoModel.SettleMillis = tSettleMillis;
+    eeprom_update_block((void*) &tEepromServoModel, (void*) EEPROM_US_SERVO_MODEL_ADDRESS, sizeof(EepromServoModelStruct));
+    return true;
+}
+
+/*
+ * Keeps the default model of the Servo library if no plausible values are stored
+ */
+void readUSServoModelFromEeprom() {
+    EepromServoModelStruct tEepromServoModel;
+    eeprom_read_block((void*) &tEepromServoModel, (void*) EEPROM_US_SERVO_MODEL_ADDRESS, sizeof(EepromServoModelStruct));
+    if (tEepromServoModel.MicrosPerDegree >= SERVO_MIN_MICROS_PER_DEGREE
+            && tEepromServoModel.MicrosPerDegree <= SERVO_MAX_MICROS_PER_DEGREE) {
+        USDistanceServo.setMotionModel(tEepromServoModel.MicrosPerDegree, tEepromServoModel.SettleMillis);
+    }
+}
+
+/*
+ * Mean echo time of TURN_CALIBRATION_PINGS pings at aServoDegrees. Returns 0 if one ping has no echo.
+ */
+static unsigned int getTurnCalibrationMicros(uint8_t aServoDegrees) {
+    US_ServoWriteAndDelay(aServoDegrees, true);
+    unsigned int tTimeoutMicros = US_TIMEOUT_CENTIMETER * 59;
+    unsigned long tSumMicros = 0;
+    for (uint8_t i = 0; i < TURN_CALIBRATION_PINGS; ++i) {
+        delay(US_TIMEOUT_MILLIS); // to avoid receiving the echo of the last ping
+        unsigned int tMicros = getUSDistance(tTimeoutMicros);
+        if (tMicros >= tTimeoutMicros) {
+            return 0;
+        }
+        tSumMicros += tMicros;
+    }
+    return tSumMicros / TURN_CALIBRATION_PINGS;
+}
+
+/*
+ * Direction of the normal of a flat wall relative to the car heading, positive is left.
+ * The distance to the wall in direction b is D / cos(b - normal). For the directions center - aperture (right)
+ * and center + aperture (left) this gives tan(normal - center) = (right - left) / ((right + left) * tan(aperture)).
+ */
+static bool measureWallNormalDegrees(int8_t aCenterDegrees, float * aNormalDegrees) {
+    unsigned int tRightMicros = getTurnCalibrationMicros(90 + aCenterDegrees - TURN_CALIBRATION_HALF_APERTURE_DEGREES);
+    unsigned int tLeftMicros = getTurnCalibrationMicros(90 + aCenterDegrees + TURN_CALIBRATION_HALF_APERTURE_DEGREES);
+    if (tRightMicros == 0 || tLeftMicros == 0) {
+        return false;
+    }
+    float tRatio = ((float) tRightMicros - (float) tLeftMicros) / ((float) tRightMicros + (float) tLeftMicros);
+    *aNormalDegrees = aCenterDegrees + (atan(tRatio / tan(TURN_CALIBRATION_HALF_APERTURE_DEGREES * DEG_TO_RAD)) * RAD_TO_DEG);
+    return true;
+}
+
+/*
+ * Learn the turn factors for both directions at slow and normal speed.
+ * The car turns alternating left and right by TURN_CALIBRATION_DEGREES and the real rotation is taken
+ * from the change of the direction of the wall normal. Each factor is the least squares fit of count over real degrees.
+ * Returns false and keeps the old factors if the wall is not seen or a rotation is not plausible.
+ */
+bool calibrateTurnFactors() {
+    float tNormalDegrees;
+    if (!measureWallNormalDegrees(0, &tNormalDegrees)) {
+        return false;
+    }
+    float tCountTimesDegreesSum[NUMBER_OF_TURN_FACTORS] = { 0 };
+    float tDegreesSquareSum[NUMBER_OF_TURN_FACTORS] = { 0 };
+
+    for (uint8_t tSpeedIndex = 0; tSpeedIndex < 2; ++tSpeedIndex) {
+        bool tUseSlowSpeed = (tSpeedIndex == 0);
+        for (uint8_t i = 0; i < 2 * TURN_CALIBRATION_REPEATS; ++i) {
+            int16_t tCommandedDegrees = (i & 0x01) ? -TURN_CALIBRATION_DEGREES : TURN_CALIBRATION_DEGREES;
+            uint8_t tFactorIndex = RobotCar.getTurnFactorIndex(tCommandedDegrees, tUseSlowSpeed);
+            // count as computed by initRotateCar() for TURN_IN_PLACE
+            long tCount = (((long) TURN_CALIBRATION_DEGREES * RobotCar.TurnFactors[tFactorIndex]) + (TURN_FACTOR_SCALE / 2))
+                    / TURN_FACTOR_SCALE;
+            tCount = 2 * (tCount / 2);
+            RobotCar.rotateCar(tCommandedDegrees, TURN_IN_PLACE, tUseSlowSpeed);
+            delay(100);
+
+            // the wall normal is expected at the opposite of the rotation
+            float tNewNormalDegrees;
+            if (!measureWallNormalDegrees((int8_t) (tNormalDegrees - tCommandedDegrees), &tNewNormalDegrees)) {
+                return false;
+            }
+            float tRealDegrees = tNormalDegrees - tNewNormalDegrees;
+            if (tCommandedDegrees < 0) {
+                tRealDegrees = -tRealDegrees;
+            }
+            if (tRealDegrees < TURN_CALIBRATION_DEGREES / 2 || tRealDegrees > 2 * TURN_CALIBRATION_DEGREES) {
+                return false;
+            }
+            tCountTimesDegreesSum[tFactorIndex] += tCount * tRealDegrees;
+            tDegreesSquareSum[tFactorIndex] += tRealDegrees * tRealDegrees;
+            tNormalDegrees = tNewNormalDegrees;
+        }
+    }
+    US_ServoWriteAndDelay(90);
+
+    for (uint8_t i = 0; i < NUMBER_OF_TURN_FACTORS; ++i) {
+        RobotCar.TurnFactors[i] = ((tCountTimesDegreesSum[i] / tDegreesSquareSum[i]) * TURN_FACTOR_SCALE) + 0.5;
+    }
+    RobotCar.writeTurnFactorsToEeprom();
+    return true;
+}
+
+/*
+ * Adaptive sweep planner
+ * Age of each value of RawDistancesArray in sweeps, 0 means measured in the last sweep.
+ */
+uint8_t sSweepAgeArray[NUMBER_OF_DISTANCES];
+
+/*
+ * Returns true if the value at aIndex is far enough to be of no interest for collision detection
+ */
+bool isClearDistance(uint8_t aIndex) {
+    return sForwardDistancesInfo.RawDistancesArray[aIndex] > (2 * sCountPerScan);
+}
+
+/*
+ * Returns a bit mask of the indexes to measure in the next sweep. Bit 0 is INDEX_RIGHT.
+ * The forward indexes are always measured.
+ * Indexes of fixed sensors are only measured by the servo, if the fixed sensor was not fired during the last sweep,
+ * e.g. because all servo moves were too short.
+ * The sides are measured if their last value was not clear or is next to an obstacle edge.
+ * Clear sides are refreshed every SWEEP_CLEAR_MAX_AGE sweep only.
+ * At higher speed, the fan is narrowed down to SWEEP_MIN_FAN_HALF_WIDTH indexes at each side of forward.
+ */
+uint16_t planSweep() {
+    uint8_t tFanHalfWidth = NUMBER_OF_DISTANCES / 2;
+    if (leftEncoderMotor.MaxSpeed > 0) {
+        tFanHalfWidth -= ((uint16_t) leftEncoderMotor.ActualSpeed * SWEEP_FAN_NARROWING_AT_MAX_SPEED)
+                / leftEncoderMotor.MaxSpeed;
+        if (tFanHalfWidth < SWEEP_MIN_FAN_HALF_WIDTH) {
+            tFanHalfWidth = SWEEP_MIN_FAN_HALF_WIDTH;
+        }
+    }
+    uint8_t tFirstFanIndex = (NUMBER_OF_DISTANCES / 2) - tFanHalfWidth;
+    uint8_t tLastFanIndex = ((NUMBER_OF_DISTANCES - 1) / 2) + tFanHalfWidth;
+
+    uint16_t tPlan = 0;
+    for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+        bool tDoMeasure;
+        if ((sFixedSensorIndexMask & (1 << i)) && sSweepAgeArray[i] == 0) {
+            // measured by a fixed sensor during the servo movements
+            tDoMeasure = false;
+        } else if (i >= INDEX_FORWARD_1 - 1 && i <= INDEX_FORWARD_2 + 1) {
+            tDoMeasure = true;
+        } else if (sSweepAgeArray[i] >= SWEEP_CLEAR_MAX_AGE - 1) {
+            // refresh old values even outside of the fan.
+            // The ages are incremented after planning, so this is every SWEEP_CLEAR_MAX_AGE sweep.
+            tDoMeasure = true;
+        } else if (i < tFirstFanIndex || i > tLastFanIndex) {
+            tDoMeasure = false;
+        } else if (!isClearDistance(i)) {
+            tDoMeasure = true;
+        } else {
+            // clear side, measure only if at an obstacle edge
+            uint8_t tDistance = sForwardDistancesInfo.RawDistancesArray[i];
+            tDoMeasure = (i > 0 && abs(tDistance - sForwardDistancesInfo.RawDistancesArray[i - 1]) > SWEEP_EDGE_CENTIMETER)
+                    || (i < STEPS_PER_180_DEGREES
+                            && abs(tDistance - sForwardDistancesInfo.RawDistancesArray[i + 1]) > SWEEP_EDGE_CENTIMETER);
+        }
+        if (tDoMeasure) {
+            tPlan |= (1 << i);
+        }
+    }
+    return tPlan;
+}
+
+/*
+ * Forward sentinel pings
+ */
+uint8_t sSideSamplesPerSentinel;
+uint16_t sMaxForwardDetectionLatencyMillis; // worst case time between 2 forward measurements of the last sweep
+unsigned int sSentinelCentimeter;
+
+/*
+ * Time to collision of the last forward measurement.
+ * Returns TTC_INFINITE if the car is stopped.
+ */
+uint16_t getForwardTimeBudgetMillis() {
+    if (RobotCar.isStopped()) {
+        return TTC_INFINITE;
+    }
+    return sTimeToCollisionMillis;
+}
+
+/*
+ * Number of side samples, which can be taken before the next forward measurement is due.
+ * Each side sample costs one servo step and one US timeout. Half of the budget is kept for the servo moves to and from forward.
+ * Returns NUMBER_OF_DISTANCES if no sentinel pings are required.
+ */
+uint8_t computeSideSamplesPerSentinel() {
+    uint16_t tBudgetMillis = getForwardTimeBudgetMillis();
+    if (tBudgetMillis == TTC_INFINITE) {
+        return NUMBER_OF_DISTANCES;
+    }
+    uint16_t tSideSampleMillis = ((18L * USDistanceServo.microsPerDegree) / 1000) + USDistanceServo.settleMillis
+            + US_TIMEOUT_MILLIS;
+    uint16_t tSamples = (tBudgetMillis / 2) / tSideSampleMillis;
+    if (tSamples < 1) {
+        tSamples = 1;
+    } else if (tSamples > NUMBER_OF_DISTANCES) {
+        tSamples = NUMBER_OF_DISTANCES;
+    }
+    return tSamples;
+}
+
+/*
+ * Look straight ahead and slow down, stop or reverse if an obstacle is near.
+ * The servo is moved back to the next sweep position by the next US_ServoWriteAndDelay().
+ */
+void doSentinelPing() {
+    US_ServoWriteAndDelay(US_SENTINEL_DEGREES, true);
+    sEchoWaitMillisFullHorizon += US_TIMEOUT_MILLIS;
+    sSentinelCentimeter = getUSDistanceAsCentiMeterWithCentimeterTimeout(US_TIMEOUT_CENTIMETER);
+    checkForwardDistance(sSentinelCentimeter);
+}
+
+/*
+ * Fixed US sensors
+ */
+uint16_t sFixedSensorIndexMasks[US_MAX_NUMBER_OF_SENSORS]; // indexes of RawDistancesArray covered by each sensor
+uint16_t sFixedSensorIndexMask; // indexes covered by all fixed sensors
+
+/*
+ * Compute the covered indexes for all fixed sensors of the sensor array
+ */
+void initFixedUSSensors() {
+    sFixedSensorIndexMask = 0;
+    for (uint8_t tSensorIndex = 0; tSensorIndex < sNumberOfUSSensors; ++tSensorIndex) {
+        uint16_t tMask = 0;
+        uint8_t tSensorDegrees = sUSSensors[tSensorIndex].AngleDegrees;
+        if (tSensorDegrees != US_SENSOR_ON_SERVO) {
+            for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+                if (abs((int) tSensorDegrees - (10 + (18 * i))) <= FIXED_SENSOR_COVERAGE_DEGREES) {
+                    tMask |= (1 << i);
+                }
+            }
+        }
+        sFixedSensorIndexMasks[tSensorIndex] = tMask;
+        sFixedSensorIndexMask |= tMask;
+    }
+}
+
+// set if a fixed sensor looking forward was fired by the last servo move. Short moves leave no time for firing.
+bool sFixedForwardSensorWasFired;
+
+/*
+ * Store the last measurement of a fixed sensor in all of its indexes and check for collision if it looks forward
+ */
+void storeFixedUSSensorDistance(uint8_t aSensorIndex) {
+    unsigned int tDistance = sUSSensors[aSensorIndex].Centimeter;
+    uint16_t tMask = sFixedSensorIndexMasks[aSensorIndex];
+    for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+        if (tMask & (1 << i)) {
+            sForwardDistancesInfo.RawDistancesArray[i] = tDistance;
+            sSweepAgeArray[i] = 0;
+            sUSHorizonArray[i] = US_TIMEOUT_CENTIMETER;
+            addToDistanceHistory(i, tDistance);
+        }
+    }
+    if (tMask & ((1 << INDEX_FORWARD_1) | (1 << INDEX_FORWARD_2))) {
+        sFixedForwardSensorWasFired = true;
+        checkForwardDistance(tDistance);
+    }
+}
+
+/*
+ * Use the time until the servo is settled for measuring the fixed sensors.
+ * No sensor is fired later than US_CROSSTALK_GUARD_MILLIS before the servo is settled,
+ * to avoid crosstalk with the measurement of the servo sensor.
+ */
+void measureFixedUSSensorsWhileServoMoves() {
+    if (sFixedSensorIndexMask == 0) {
+        return;
+    }
+    while (USDistanceServo.getMillisUntilSettled() > US_CROSSTALK_GUARD_MILLIS + US_TIMEOUT_MILLIS) {
+        int8_t tSensorIndex = measureNextUSSensor(US_TIMEOUT_CENTIMETER);
+        if (tSensorIndex >= 0) {
+            storeFixedUSSensorDistance(tSensorIndex);
+        }
+    }
+}
+
+/*
+ * Echo horizon
+ */
+uint16_t sEchoWaitMillis;
+uint16_t sEchoWaitMillisFullHorizon;
+
+/*
+ * The full US_TIMEOUT_CENTIMETER is used straight ahead and if the car is stopped, since the next turn decision needs it.
+ * Otherwise an obstacle is of interest, if it is nearer than the look ahead distance in driving direction
+ * and nearer than US_HORIZON_LATERAL_CENTIMETER perpendicular to it.
+ * The look ahead distance is the braking distance plus the distance driven in the next 2 sweeps plus MINIMUM_DISTANCE_TO_FRONT.
+ */
+unsigned int getUSHorizonCentimeter(uint8_t aIndex) {
+    if (RobotCar.isStopped() || aIndex == INDEX_FORWARD_1 || aIndex == INDEX_FORWARD_2) {
+        return US_TIMEOUT_CENTIMETER;
+    }
+    uint16_t tLookAheadCentimeter = getBrakingCentimeter() + (2 * sCentimeterPerScan) + MINIMUM_DISTANCE_TO_FRONT;
+    // the sweep angles are never 0 or 180 degrees, so the sinus is never 0
+    uint16_t tHorizon = ((uint32_t) tLookAheadCentimeter << 8) / getSweepSinus256(aIndex);
+    uint16_t tLateralHorizon = (US_HORIZON_LATERAL_CENTIMETER << 8) / getSweepCosinus256(aIndex);
+    if (tHorizon > tLateralHorizon) {
+        tHorizon = tLateralHorizon;
+    }
+    if (tHorizon > US_TIMEOUT_CENTIMETER) {
+        tHorizon = US_TIMEOUT_CENTIMETER;
+    }
+    return tHorizon;
+}
+
+/*
+ * Horizon of the last measurement of each index. A US_TIMEOUT_CENTIMETER value of RawDistancesArray is only known to be free
+ * up to this distance. 0 if the index was never measured.
+ */
+uint8_t sUSHorizonArray[NUMBER_OF_DISTANCES];
+
+/*
+ * Distances beyond the horizon are returned as US_TIMEOUT_CENTIMETER, i.e. as of no interest for collision detection
+ */
+unsigned int getUSDistanceForIndex(uint8_t aIndex) {
+    sEchoWaitMillisFullHorizon += US_TIMEOUT_MILLIS;
+    unsigned int tHorizon = getUSHorizonCentimeter(aIndex);
+    sUSHorizonArray[aIndex] = tHorizon;
+    return getUSDistanceAsCentiMeterWithHorizon(tHorizon, US_TIMEOUT_CENTIMETER);
+}
+
+/*
+ * Scan cache
+ */
+bool sScanCacheIsValid = false;
+int16_t sScanCacheEncoderPosition; // sum of both wheel positions at the end of the last sweep
+
+int16_t getEncoderPositionSum() {
+    noInterrupts();
+    int16_t tPosition = leftEncoderMotor.EncoderPosition + rightEncoderMotor.EncoderPosition;
+    interrupts();
+    return tPosition;
+}
+
+void invalidateScanCache() {
+    sScanCacheIsValid = false;
+}
+
+/*
+ * Re-index the distances after a rotation. Positive degrees -> car turned left -> obstacles moved right to lower indexes.
+ * Indexes, which have no value from the last sweep, are marked as never measured.
+ * The rotated values get at least the age SWEEP_CLEAR_MAX_AGE, so they are measured again by the next sweep,
+ * since the rotation is not exact. The filtered values are rotated too, until then they are read by doWallDetection().
+ */
+void rotateScanCache(int aRotationDegrees) {
+    int8_t tShift;
+    if (aRotationDegrees >= 0) {
+        tShift = (aRotationDegrees + (SWEEP_DEGREES_PER_INDEX / 2)) / SWEEP_DEGREES_PER_INDEX;
+    } else {
+        tShift = -((-aRotationDegrees + (SWEEP_DEGREES_PER_INDEX / 2)) / SWEEP_DEGREES_PER_INDEX);
+    }
+    if (tShift == 0) {
+        return;
+    }
+    uint8_t * tDistances = sForwardDistancesInfo.RawDistancesArray;
+    for (uint8_t j = 0; j < NUMBER_OF_DISTANCES; ++j) {
+        // copy in a direction, which does not overwrite values still to be copied
+        uint8_t i = (tShift > 0) ? j : (STEPS_PER_180_DEGREES - j);
+        int8_t tSourceIndex = i + tShift;
+        if (tSourceIndex >= 0 && tSourceIndex < NUMBER_OF_DISTANCES) {
+            tDistances[i] = tDistances[tSourceIndex];
+            sFilteredDistancesArray[i] = sFilteredDistancesArray[tSourceIndex];
+            sSweepAgeArray[i] = max(sSweepAgeArray[tSourceIndex], (uint8_t) SWEEP_CLEAR_MAX_AGE);
+            sUSHorizonArray[i] = sUSHorizonArray[tSourceIndex];
+        } else {
+            tDistances[i] = US_TIMEOUT_CENTIMETER;
+            sFilteredDistancesArray[i] = US_TIMEOUT_CENTIMETER;
+            sSweepAgeArray[i] = 0xFF;
+            sUSHorizonArray[i] = 0;
+        }
+    }
+}
+
+/*
+ * Positive if car has moved forward since the last sweep
+ */
+int16_t getScanCacheMovedCentimeter() {
+    return (getEncoderPositionSum() - sScanCacheEncoderPosition) / (2 * FACTOR_CENTIMETER_TO_COUNT);
+}
+
+/*
+ * Returns true, if the cached sweep can be used and compensates its values for the small movement of the car
+ */
+bool useScanCache() {
+    if (!sScanCacheIsValid || !RobotCar.isStopped()) {
+        return false;
+    }
+    int16_t tMovedCentimeter = getScanCacheMovedCentimeter();
+    if (abs(tMovedCentimeter) > SCAN_CACHE_MAX_MOVE_CENTIMETER) {
+        return false;
+    }
+    for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+        int tDistance = sForwardDistancesInfo.RawDistancesArray[i];
+        if (tDistance < US_TIMEOUT_CENTIMETER) {
+            tDistance -= (tMovedCentimeter * getSweepSinus256(i)) / 256;
+            sForwardDistancesInfo.RawDistancesArray[i] = constrain(tDistance, 0, US_TIMEOUT_CENTIMETER);
+        }
+    }
+    return true;
+}
+
+/*
+ * Closed loop turns
+ */
+#ifdef USE_US_FAN_TURN_FEEDBACK
+bool (*sGetRealRotationDegreesFunction)(int16_t * aRealRotationDegrees) = &getUSRealRotationDegrees;
+#else
+bool (*sGetRealRotationDegreesFunction)(int16_t * aRealRotationDegrees) = NULL;
+#endif
+
+/*
+ * Measures only the indexes which can be matched with the sweep before the turn.
+ * The values are measured at an intermediate orientation,
+ * so they are not stored in the sweep, the scan cache or the distance history.
+ */
+bool getUSRealRotationDegrees(int16_t * aRealRotationDegrees) {
+    uint8_t tDistances[NUMBER_OF_DISTANCES];
+    uint16_t tMask = getScanMatchIndexMask();
+    for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+        // same direction as fillForwardDistancesInfo()
+        uint8_t tIndex = (sLastServoAngleInDegrees >= 90) ? STEPS_PER_180_DEGREES - i : i;
+        if (tMask & (1 << tIndex)) {
+            US_ServoWriteAndDelay(10 + (tIndex * SWEEP_DEGREES_PER_INDEX) + 3, true);
+            tDistances[tIndex] = getUSDistanceAsCentiMeterWithHorizon(getUSHorizonCentimeter(tIndex), US_TIMEOUT_CENTIMETER);
+        }
+    }
+    return getScanMatchRotationDegrees(tDistances, tMask, aRealRotationDegrees);
+}
+
+/*
+ * Handles the phone events and polls the MPU-6050 during the turn
+ */
+void loopGUIAndHeadingFusion() {
+    loopGUI();
+    updateHeadingFusion();
+}
 
-//        // wait at least 5 ms for the servo to receive signal
-//        delay(SERVO_INITIAL_DELAY);
-//        digitalWrite(DEBUG_OUT_PIN, LOW);
+/*
+ * Returns the real rotation or aRotationDegrees if it was not measured.
+ * The heading fusion is preferred, since it needs no sweep.
+ * Without heading fusion, the residual error is corrected by the scan matching after the next sweep.
+ */
+int rotateCarWithFeedback(int aRotationDegrees) {
+    if (aRotationDegrees == 0) {
+        return 0;
+    }
+    if (isHeadingFusionValid()) {
+        markHeadingFusionTurnStart(aRotationDegrees);
+        if (sTurnMode == TURN_IN_PLACE) {
+            return RobotCar.rotateCarClosedLoop(aRotationDegrees, &getFusedRealRotationDegrees, &loopGUIAndHeadingFusion);
+        }
+        RobotCar.rotateCar(aRotationDegrees, &loopGUIAndHeadingFusion, sTurnMode);
+        int16_t tRealRotationDegrees = aRotationDegrees;
+        getFusedRealRotationDegrees(&tRealRotationDegrees);
+        return tRealRotationDegrees;
+    }
+    if (sGetRealRotationDegreesFunction != NULL && sTurnMode == TURN_IN_PLACE) {
+        return RobotCar.rotateCarClosedLoop(aRotationDegrees, sGetRealRotationDegreesFunction, NULL);
+    }
+    RobotCar.rotateCar(aRotationDegrees, sTurnMode);
+    return aRotationDegrees;
+}
 
-        // factor 8 gives a fairly reproducible result, factor 4 is a bit too fast
-        uint16_t tWaitDelayforServo = tDeltaDegrees * 7;
-        delay(tWaitDelayforServo);
+/*
+ * Rotates the car and updates exploration pose, scan matching, distance history and scan cache with the real rotation.
+ * Returns the rotation for insertToPath().
+ */
+int rotateCarAndUpdatePose(int aRotationDegrees) {
+    if (aRotationDegrees == 0) {
+        return getDegreesTurnedForPath(0);
     }
+    // the distance driven before the turn has the old heading
+    updateExplorationPose();
+    addScanMatchRotation(aRotationDegrees);
+    int tRealRotationDegrees = rotateCarWithFeedback(aRotationDegrees);
+    // the scan match after the next sweep corrects only the remaining error
+    addScanMatchRotation(tRealRotationDegrees - aRotationDegrees);
+    rotateExplorationPose(tRealRotationDegrees);
+    // after the last correction of a closed loop turn
+    resetDistanceHistory();
+    rotateScanCache(tRealRotationDegrees);
+    return getDegreesTurnedForPath(tRealRotationDegrees);
 }
 
 /*
- * Get 7 distances starting at 10 degree (right) increasing by 18 degrees up to 170 degrees (left)
+ * With heading fusion, the rotation for insertToPath() is taken from the fused heading
+ */
+int getDegreesTurnedForPath(int aRotationDegrees) {
+    if (!isHeadingFusionValid()) {
+        return aRotationDegrees;
+    }
+    int tDegrees = (getFusedHeadingDegrees() - sLastPathDirectionDegree) % 360;
+    if (tDegrees >= 180) {
+        tDegrees -= 360;
+    } else if (tDegrees < -180) {
+        tDegrees += 360;
+    }
+    return tDegrees;
+}
+
+/*
+ * Get up to 10 distances starting at 10 degree (right) increasing by 18 degrees up to 170 degrees (left)
  * Avoid 0 and 180 degree since at this position the US sensor might see the wheels of the car as an obstacle.
- * aDoFirstValue if false, skip first value since it is the same as last value of last measurement in continuous mode.
+ * Only the indexes chosen by planSweep() are measured, the others keep their value from the last sweep.
+ * The sweep starts at the end of the fan which is nearest to the actual servo position.
+ * aDoFirstValue if false, skip first value if it is the same as last value of last measurement in continuous mode.
  *
  * Wall detection:
  * If 2 or 3 adjacent values are quite short and the surrounding values are quite far,
@@ -104,76 +695,158 @@ bool fillForwardDistancesInfo(bool aShowValues, bool aDoFirstValue) {
 
     color16_t tColor;
 
+    bool tUseScanCache = useScanCache();
+    uint16_t tPlan = planSweep();
+    sSideSamplesPerSentinel = computeSideSamplesPerSentinel();
+    uint8_t tSideSamplesSinceForward = 0;
+    sFixedForwardSensorWasFired = false;
+    unsigned long tLastForwardMillis = millis();
+    sMaxForwardDetectionLatencyMillis = 0;
+    unsigned long tStartEchoWaitMicros = sUSEchoWaitMicros;
+    sEchoWaitMillisFullHorizon = 0;
+    for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+        if (sSweepAgeArray[i] < 0xFF) {
+            sSweepAgeArray[i]++;
+        }
+    }
+
+    if (tUseScanCache) {
+        /*
+         * Check the index at the actual servo position. If it has not changed, measure only the stale indexes.
+         */
+        int8_t tCheckIndex = ((int) sLastServoAngleInDegrees - 10 + (SWEEP_DEGREES_PER_INDEX / 2) - 3) / SWEEP_DEGREES_PER_INDEX;
+        tCheckIndex = constrain(tCheckIndex, 0, STEPS_PER_180_DEGREES);
+        US_ServoWriteAndDelay(10 + (tCheckIndex * SWEEP_DEGREES_PER_INDEX) + 3, true);
+        unsigned int tDistance = getUSDistanceForIndex(tCheckIndex);
+        uint8_t tCachedDistance = sForwardDistancesInfo.RawDistancesArray[tCheckIndex];
+        sForwardDistancesInfo.RawDistancesArray[tCheckIndex] = tDistance;
+        sSweepAgeArray[tCheckIndex] = 0;
+        addToDistanceHistory(tCheckIndex, tDistance);
+        if (abs((int) tDistance - (int) tCachedDistance) <= DISTANCE_OUTLIER_CENTIMETER) {
+            uint16_t tStalePlan = 0;
+            for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+                if (sSweepAgeArray[i] >= SWEEP_CLEAR_MAX_AGE) {
+                    tStalePlan |= (1 << i);
+                }
+            }
+            // keep the indexes of fixed sensors, which were not fired during the last sweep
+            tPlan = tStalePlan | (tPlan & sFixedSensorIndexMask);
+        }
+        tPlan &= ~(1 << tCheckIndex);
+    }
+
 // Values for forward scanning
     // Quick hack for scanning from 10 to 170 degree to avoid to detect my own wheels
-//    uint8_t tActualDegrees = 0;
-//    int8_t tDegreeIncrement = DEGREES_PER_STEP;
     uint8_t tActualDegrees = 10;
     int8_t tDegreeIncrement = 18;
     int8_t tIndex = 0;
     int8_t tIndexDelta = 1;
-    if (sLastServoAngleInDegrees >= 170) {
+    if (sLastServoAngleInDegrees >= 90) {
 // values for backward scanning
-//        tActualDegrees = 180;
         tActualDegrees = 170;
         tDegreeIncrement = -(tDegreeIncrement);
         tIndex = STEPS_PER_180_DEGREES;
         tIndexDelta = -1;
     }
-    if (!aDoFirstValue) {
-// skip first value, since it is equal to last value of last measurement
-        tIndex += tIndexDelta;
-        tActualDegrees += tDegreeIncrement;
-    }
+    bool tIsFirstValue = true;
 
     while (tIndex >= 0 && tIndex < NUMBER_OF_DISTANCES) {
-        /*
-         * rotate servo, wait and get distance
-         */
-        /*
-         * compensate (set target to more degrees) for fast servo speed
-         * Reasonable value is between 2 and 3 at 20 degrees and tWaitDelayforServo = tDeltaDegrees * 5
-         * Reasonable value is between 10 and 20 degrees and tWaitDelayforServo = tDeltaDegrees * 4 => avoid it
-         */
-        US_ServoWriteAndDelay(tActualDegrees + 3, true);
+        if (tPlan & (1 << tIndex)) {
+            if (tIsFirstValue && !aDoFirstValue && sSweepAgeArray[tIndex] == 1) {
+                // skip first value, since it is equal to last value of last measurement
+                tIsFirstValue = false;
+            } else {
+                tIsFirstValue = false;
+                /*
+                 * rotate servo, wait and get distance
+                 */
+                /*
+                 * compensate (set target to more degrees) for fast servo speed
+                 * Reasonable value is between 2 and 3 at 20 degrees and tWaitDelayforServo = tDeltaDegrees * 5
+                 * Reasonable value is between 10 and 20 degrees and tWaitDelayforServo = tDeltaDegrees * 4 => avoid it
+                 */
+                US_ServoWriteAndDelay(tActualDegrees + 3, true);
 
-        unsigned int tDistance = getUSDistanceAsCentiMeterWithCentimeterTimeout(US_TIMEOUT_CENTIMETER);
+                unsigned int tDistance = getUSDistanceForIndex(tIndex);
+                bool tChangeIsConfirmed = false;
+                if (isDistanceOutlier(tIndex, tDistance)) {
+                    // ping again and take the new value if it matches the history
+                    unsigned int tSecondDistance = getUSDistanceForIndex(tIndex);
+                    if (!isDistanceOutlier(tIndex, tSecondDistance)) {
+                        tDistance = tSecondDistance;
+                    } else if (abs((int) tSecondDistance - (int) tDistance) <= DISTANCE_OUTLIER_CENTIMETER) {
+                        // both pings see the new obstacle or the free space
+                        tChangeIsConfirmed = true;
+                    }
+                }
 
-        if (((tIndex == INDEX_FORWARD_1 || tIndex == INDEX_FORWARD_2) && tDistance <= sCountPerScan)
-                || (!sRunAutonomousDrive)) {
-            /*
-             * Emergency stop
-             */
-            RobotCar.stopCar();
-        }
+                if (tIndex == INDEX_FORWARD_1 || tIndex == INDEX_FORWARD_2) {
+                    /*
+                     * Slow down, emergency stop or reverse depending on time to collision
+                     */
+                    checkForwardDistance(tDistance);
+                }
+                if (!sRunAutonomousDrive) {
+                    RobotCar.stopCar();
+                }
 
-        if (aShowValues) {
-            /*
-             * Determine color
-             */
-            tColor = COLOR_ORANGE;
-            if (tDistance >= US_TIMEOUT_CENTIMETER || tDistance > sCountPerScan) {
-                tColor = COLOR_GREEN;
-            } else if (tDistance < sCentimeterPerScan) {
-                tColor = COLOR_RED;
-            }
+                if (aShowValues) {
+                    /*
+                     * Determine color
+                     */
+                    tColor = COLOR_ORANGE;
+                    if (tDistance >= US_TIMEOUT_CENTIMETER || tDistance > sCountPerScan) {
+                        tColor = COLOR_GREEN;
+                    } else if (tDistance < sCentimeterPerScan) {
+                        tColor = COLOR_RED;
+                    }
 
-            /*
-             * Clear old and draw new line
-             */
-            BlueDisplay1.drawVectorDegrees(US_DISTANCE_MAP_ORIGIN_X, US_DISTANCE_MAP_ORIGIN_Y,
-                    sForwardDistancesInfo.RawDistancesArray[tIndex], tActualDegrees, COLOR_WHITE, 3);
-            BlueDisplay1.drawVectorDegrees(US_DISTANCE_MAP_ORIGIN_X, US_DISTANCE_MAP_ORIGIN_Y, tDistance, tActualDegrees, tColor,
-                    3);
-        }
-        /*
-         * Store value and search for min and max
-         */
-        sForwardDistancesInfo.RawDistancesArray[tIndex] = tDistance;
+                    /*
+                     * Clear old and draw new line
+                     */
+                    BlueDisplay1.drawVectorDegrees(US_DISTANCE_MAP_ORIGIN_X, US_DISTANCE_MAP_ORIGIN_Y,
+                            sForwardDistancesInfo.RawDistancesArray[tIndex], tActualDegrees, COLOR_WHITE, 3);
+                    BlueDisplay1.drawVectorDegrees(US_DISTANCE_MAP_ORIGIN_X, US_DISTANCE_MAP_ORIGIN_Y, tDistance, tActualDegrees,
+                            tColor, 3);
+                }
+                /*
+                 * Store value
+                 */
+                sForwardDistancesInfo.RawDistancesArray[tIndex] = tDistance;
+                sSweepAgeArray[tIndex] = 0;
+                if (tChangeIsConfirmed) {
+                    setDistanceHistory(tIndex, tDistance);
+                } else {
+                    addToDistanceHistory(tIndex, tDistance);
+                }
 
+                /*
+                 * Insert a forward sentinel ping after sSideSamplesPerSentinel side samples while driving.
+                 * Not required if a fixed forward sensor has been fired during the servo movement.
+                 */
+                bool tForwardWasMeasured = (tIndex == INDEX_FORWARD_1 || tIndex == INDEX_FORWARD_2)
+                        || sFixedForwardSensorWasFired;
+                sFixedForwardSensorWasFired = false;
+                if (!tForwardWasMeasured && !RobotCar.isStopped() && ++tSideSamplesSinceForward >= sSideSamplesPerSentinel) {
+                    doSentinelPing();
+                    tForwardWasMeasured = true;
+                }
+                if (tForwardWasMeasured) {
+                    tSideSamplesSinceForward = 0;
+                    unsigned long tMillis = millis();
+                    if (tMillis - tLastForwardMillis > sMaxForwardDetectionLatencyMillis) {
+                        sMaxForwardDetectionLatencyMillis = tMillis - tLastForwardMillis;
+                    }
+                    tLastForwardMillis = tMillis;
+                }
+            }
+        }
         tIndex += tIndexDelta;
         tActualDegrees += tDegreeIncrement;
     }
+    sEchoWaitMillis = (sUSEchoWaitMicros - tStartEchoWaitMicros) / 1000;
+    sScanCacheEncoderPosition = getEncoderPositionSum();
+    sScanCacheIsValid = true;
     return true;
 }
 
@@ -282,9 +955,9 @@ uint8_t computeNeigbourValue(uint8_t a20DegreeValue, uint8_t a40DegreeValue, uin
 void doWallDetection(bool aShowValues) {
     uint8_t tTempDistancesArray[NUMBER_OF_DISTANCES];
     /*
-     * First copy all raw values
+     * First copy all median filtered values
      */
-    memcpy(tTempDistancesArray, sForwardDistancesInfo.RawDistancesArray, NUMBER_OF_DISTANCES);
+    memcpy(tTempDistancesArray, sFilteredDistancesArray, NUMBER_OF_DISTANCES);
     uint8_t tLastValue = tTempDistancesArray[0];
     uint8_t tActualValue = tTempDistancesArray[1];
     uint8_t tNextValue;
@@ -353,9 +1026,8 @@ void doWallDetection(bool aShowValues) {
         tNextValue = tTempDistancesArray[i - 1];
 
 // Do it only if none of the 3 values are processed before
-        if (tTempDistancesArray[i + 1] == sForwardDistancesInfo.RawDistancesArray[i + 1]
-                && tTempDistancesArray[i] == sForwardDistancesInfo.RawDistancesArray[i]
-                && tNextValue == sForwardDistancesInfo.RawDistancesArray[i - 1]) {
+        if (tTempDistancesArray[i + 1] == sFilteredDistancesArray[i + 1] && tTempDistancesArray[i] == sFilteredDistancesArray[i]
+                && tNextValue == sFilteredDistancesArray[i - 1]) {
 
             /*
              * check values at i+1 and i and adjust value at i-11
@@ -401,7 +1073,6 @@ void doWallDetection(bool aShowValues) {
     doPostProcess();
 }
 
-#define GO_BACK_AND_SCAN_AGAIN 360
 /*
  * Checks distances and returns degrees to turn
  * 0 -> no turn, > 0 -> turn left, < 0 -> turn right, > 360 go back, since too close to wall
@@ -476,6 +1147,15 @@ int doBuiltInCollisionDetection() {
     return tDegreeToTurn;
 }
 
+/*
+ * For GO_BACK_AND_SCAN_AGAIN. Exploration pose and scan matching take the movement from the encoder positions.
+ */
+void goBackAndInsertToPath() {
+    RobotCar.goDistanceCentimeter(-TTC_REVERSE_DISTANCE_CENTIMETER, &loopGUI);
+    // direction is unchanged since the last entry
+    insertToPath(-(int) rightEncoderMotor.LastRideDistanceCount, 0, true);
+}
+
 /*
  * Do one step of autonomous driving
  * Compute sNextDegreesToTurn AFTER the movement to be able to stop before next turn
@@ -504,12 +1184,13 @@ void driveAutonomousOneStep(bool (*aFillForwardDistancesInfoFunction)(bool, bool
              * SINGLE_STEP -> optional turn and go fixed distance
              */
             if (sNextDegreesToTurn == GO_BACK_AND_SCAN_AGAIN) {
-                RobotCar.goDistanceCentimeter(-10, &loopGUI);
+                goBackAndInsertToPath();
+                resetDistanceHistory();
             } else {
-                RobotCar.rotateCar(sNextDegreesToTurn, sTurnMode);
-                sLastDegreesTurned = sNextDegreesToTurn;
+                sLastDegreesTurned = rotateCarAndUpdatePose(sNextDegreesToTurn);
                 sNextDegreesToTurn = 0;
                 RobotCar.goDistanceCentimeter(CENTIMETER_PER_RIDE, &loopGUI);
+                compensateDistanceHistory(CENTIMETER_PER_RIDE);
             }
         } else
         /*
@@ -517,14 +1198,16 @@ void driveAutonomousOneStep(bool (*aFillForwardDistancesInfoFunction)(bool, bool
          */
         if (RobotCar.isStopped()) {
             if (sNextDegreesToTurn == GO_BACK_AND_SCAN_AGAIN) {
-                RobotCar.goDistanceCentimeter(-10, &loopGUI);
+                goBackAndInsertToPath();
+                // the history is no longer valid after turning or going back
+                resetDistanceHistory();
             } else {
-                RobotCar.rotateCar(sNextDegreesToTurn, sTurnMode);
+                sLastDegreesTurned = rotateCarAndUpdatePose(sNextDegreesToTurn);
+                sNextDegreesToTurn = 0;
                 // wait to really stop after turning
                 delay(100);
-                sLastDegreesTurned = sNextDegreesToTurn;
-                sNextDegreesToTurn = 0;
-                RobotCar.startAndWaitForFullSpeed();
+                // speed depends on the free space ahead
+                RobotCar.startAndWaitForFullSpeed(computeGovernorSpeed());
                 tMovementJustStarted = true;
 //            delay(100);
             }
@@ -543,13 +1226,22 @@ void driveAutonomousOneStep(bool (*aFillForwardDistancesInfoFunction)(bool, bool
         }
 
         uint16_t tStartCount = leftEncoderMotor.DistanceCount;
+        unsigned long tSweepStartMillis = millis();
+        learnVelocityPerSpeed();
 
         /*
          * The magic happens HERE
          */
         bool tInfoWasProcessed = aFillForwardDistancesInfoFunction(tActualPageIsAutomaticControl, tMovementJustStarted);
+        sSweepMillis = millis() - tSweepStartMillis;
+        doScanMatchHeadingCorrection();
         doWallDetection(tActualPageIsAutomaticControl);
         sNextDegreesToTurn = aCollisionDetectionFunction();
+        if (sCollisionReverseIsRequested) {
+            // the collision response has already stopped the car during the sweep
+            sCollisionReverseIsRequested = false;
+            sNextDegreesToTurn = GO_BACK_AND_SCAN_AGAIN;
+        }
 
         /*
          * compute distance driven for one 180 degrees scan
@@ -560,11 +1252,19 @@ void driveAutonomousOneStep(bool (*aFillForwardDistancesInfoFunction)(bool, bool
              */
             sCountPerScan = leftEncoderMotor.DistanceCount - tStartCount;
             sCentimeterPerScan = sCountPerScan / 2;
+            compensateDistanceHistory(sCentimeterPerScan);
             if (tActualPageIsAutomaticControl) {
-                char tStringBuffer[6];
-                sprintf_P(tStringBuffer, PSTR("%2d%s"), sCentimeterPerScan, "cm");
+                // distance per scan and worst case forward detection latency, clipped to the field width
+                char tStringBuffer[12];
+                snprintf_P(tStringBuffer, sizeof(tStringBuffer), PSTR("%2dcm %4ums"), min(sCentimeterPerScan, (uint8_t) 99),
+                        min(sMaxForwardDetectionLatencyMillis, (uint16_t) 9999));
                 BlueDisplay1.drawText(0, BUTTON_HEIGHT_4_LINE_4 - TEXT_SIZE_11_DECEND, tStringBuffer, TEXT_SIZE_11, COLOR_BLACK,
                 COLOR_WHITE);
+                // echo wait time of the sweep and the worst case with the full horizon
+                snprintf_P(tStringBuffer, sizeof(tStringBuffer), PSTR("%3u/%3ums"), min(sEchoWaitMillis, (uint16_t) 999),
+                        min(sEchoWaitMillisFullHorizon, (uint16_t) 999));
+                BlueDisplay1.drawText(0, BUTTON_HEIGHT_4_LINE_4 - TEXT_SIZE_11_DECEND - TEXT_SIZE_11, tStringBuffer, TEXT_SIZE_11,
+                        COLOR_BLACK, COLOR_WHITE);
             }
         }
 
@@ -596,6 +1296,7 @@ void driveAutonomousOneStep(bool (*aFillForwardDistancesInfoFunction)(bool, bool
              */
             insertToPath(rightEncoderMotor.DistanceCount, sLastDegreesTurned, false);
             rightEncoderMotor.synchronizeMotor(&leftEncoderMotor, MOTOR_DEFAULT_SYNCHRONIZE_INTERVAL_MILLIS);
+            RobotCar.changeMaxSpeed(computeGovernorSpeed());
         }
         if (sActualPage == PAGE_SHOW_PATH) {
             drawPathInfoPage();
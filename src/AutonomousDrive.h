@@ -51,6 +51,38 @@ extern uint8_t sCentimeterPerScan; // = sCountPerScan / 2
 void initUSServo();
 void US_ServoWriteAndDelay(uint8_t aValue, bool doDelay = false);
 
+/*
+ * Servo calibration
+ */
+#define SERVO_CALIBRATION_TARGET_DEGREES 90
+#define SERVO_CALIBRATION_SHORT_MOVE_DEGREES 40
+#define SERVO_CALIBRATION_LONG_MOVE_DEGREES 80
+#define SERVO_CALIBRATION_REPEATS 3
+#define SERVO_CALIBRATION_TOLERANCE_CENTIMETER 3
+// The US sensor sees a narrow target up to 15 degrees off axis
+#define US_BEAM_HALF_ANGLE_DEGREES 15
+// plausible range of the calibrated speed
+#define SERVO_MIN_MICROS_PER_DEGREE 500
+#define SERVO_MAX_MICROS_PER_DEGREE 20000
+// stored behind the record ring of MotorInfoStorage
+#define EEPROM_US_SERVO_MODEL_ADDRESS (EEPROM_MOTOR_INFO_RING_ADDRESS + (MOTOR_INFO_RING_SLOTS * sizeof(MotorInfoRecordStruct)))
+struct EepromServoModelStruct {
+    uint16_t MicrosPerDegree;
+    uint8_t SettleMillis;
+};
+bool calibrateUSServo();
+void readUSServoModelFromEeprom();
+
+/*
+ * Turn calibration. The car must face a flat wall at 20 to 60 cm.
+ */
+#define TURN_CALIBRATION_DEGREES 30
+// the wall normal is computed from the distances at this angle right and left of the expected normal
+#define TURN_CALIBRATION_HALF_APERTURE_DEGREES 20
+#define TURN_CALIBRATION_PINGS 4
+#define TURN_CALIBRATION_REPEATS 2
+bool calibrateTurnFactors();
+
 /*
  * Values for included implementation
  */
@@ -58,12 +90,77 @@ const int CENTIMETER_PER_RIDE = 25;
 
 // do not measure and process distances greater than 100 cm
 #define US_TIMEOUT_CENTIMETER 100
+#define US_TIMEOUT_MILLIS ((US_TIMEOUT_CENTIMETER * 59) / 1000 + 1)
 
 // I measured ca. 110 ms
 const int MILLIS_FOR_SERVO_20_DEGREES = 120;
 
+/*
+ * Adaptive sweep
+ */
+#define SWEEP_CLEAR_MAX_AGE 3 // clear side values are measured at least every 3. sweep
+#define SWEEP_EDGE_CENTIMETER 20 // minimum difference of adjacent values for an obstacle edge
+#define SWEEP_MIN_FAN_HALF_WIDTH 3 // at least indexes 2 to 7 are scanned
+#define SWEEP_FAN_NARROWING_AT_MAX_SPEED 2 // number of indexes at each side, which are skipped at max speed
+extern uint8_t sSweepAgeArray[NUMBER_OF_DISTANCES];
+uint16_t planSweep();
+
+/*
+ * Forward sentinel pings between the side samples of a sweep, driven by the time budget until collision
+ */
+#define US_SENTINEL_DEGREES 90
+extern uint8_t sSideSamplesPerSentinel;
+extern uint16_t sMaxForwardDetectionLatencyMillis;
+extern unsigned int sSentinelCentimeter;
+uint16_t getForwardTimeBudgetMillis(); // uses the time to collision
+uint8_t computeSideSamplesPerSentinel();
+void doSentinelPing();
+
+/*
+ * Fixed US sensors of the HCSR04 sensor array. They are measured while the servo moves.
+ * A fixed sensor fills all indexes whose angle is not more than FIXED_SENSOR_COVERAGE_DEGREES away from its own angle.
+ */
+#define FIXED_SENSOR_COVERAGE_DEGREES 10
+extern uint16_t sFixedSensorIndexMask; // Bit 0 is INDEX_RIGHT
+void initFixedUSSensors();
+void storeFixedUSSensorDistance(uint8_t aSensorIndex);
+void measureFixedUSSensorsWhileServoMoves();
+
+/*
+ * Echo horizon. While driving, the sides are measured only up to the distance, which can be reached
+ * before the next sweep or which is laterally near the path of the car.
+ */
+#define US_HORIZON_LATERAL_CENTIMETER 40
+extern uint16_t sEchoWaitMillis; // of last sweep
+extern uint16_t sEchoWaitMillisFullHorizon; // of last sweep, if all samples would have used US_TIMEOUT_CENTIMETER as horizon
+extern uint8_t sUSHorizonArray[NUMBER_OF_DISTANCES];
+unsigned int getUSHorizonCentimeter(uint8_t aIndex);
+unsigned int getUSDistanceForIndex(uint8_t aIndex);
+
+/*
+ * Scan cache. The last sweep is reused, if the car is stopped and has moved less than SCAN_CACHE_MAX_MOVE_CENTIMETER since.
+ * Then only stale indexes are measured, and one index to check if the scene has changed.
+ */
+#define SCAN_CACHE_MAX_MOVE_CENTIMETER 2
+#define SWEEP_DEGREES_PER_INDEX 18
+int16_t getEncoderPositionSum();
+void invalidateScanCache();
+void rotateScanCache(int aRotationDegrees);
+int16_t getScanCacheMovedCentimeter();
+bool useScanCache();
+
+/*
+ * Closed loop turns. The function returns the real rotation since the start of the turn. NULL -> turns by encoder count only.
+ */
+extern bool (*sGetRealRotationDegreesFunction)(int16_t * aRealRotationDegrees);
+bool getUSRealRotationDegrees(int16_t * aRealRotationDegrees);
+int rotateCarWithFeedback(int aRotationDegrees);
+int rotateCarAndUpdatePose(int aRotationDegrees);
+int getDegreesTurnedForPath(int aRotationDegrees);
+
 bool fillForwardDistancesInfo(bool aShowValues, bool aDoFirstValue);
 void doWallDetection(bool aShowValues);
+#define GO_BACK_AND_SCAN_AGAIN 360
 int doBuiltInCollisionDetection();
 void driveAutonomousOneStep(bool (*afillForwardDistancesInfoFunction)(bool, bool), int (*aCollisionDetectionFunction)());
 
@@ -20,6 +20,13 @@
 
 #include "RobotCarGui.h"
 #include "RobotCar.h"
+#include "TimeToCollision.h"
+#include "DistanceFilter.h"
+#include "Exploration.h"
+#include "Navigation.h"
+#include "ScanMatching.h"
+#include "HeadingFusion.h"
+#include "WallFollowing.h"
 
 BDButton TouchButtonStepMode;
 BDButton TouchButtonStep;
@@ -27,6 +34,8 @@ BDButton TouchButtonSingleScan;
 
 BDButton TouchButtonTestUser;
 BDButton TouchButtonBuiltInAutonomousDrive;
+BDButton TouchButtonExplore;
+BDButton TouchButtonWallFollowing;
 
 uint8_t sStepMode = MODE_CONTINUOUS;
 bool sDoStep = false; // if true => do one step
@@ -76,6 +85,8 @@ void doStep(BDButton * aTheTouchedButton, int16_t aValue) {
 void doSingleScan(BDButton * aTheTouchedButton, int16_t aValue) {
     bool tInfoWasProcessed;
     clearPrintedForwardDistancesInfos();
+    // car may have been moved manually since last scan
+    resetDistanceHistory();
     tInfoWasProcessed = fillForwardDistancesInfo(true, true);
     doWallDetection(true);
     sNextDegreesToTurn = doBuiltInCollisionDetection();
@@ -85,6 +96,21 @@ void doSingleScan(BDButton * aTheTouchedButton, int16_t aValue) {
     }
 }
 
+/*
+ * Switches between built in and exploration strategy. Can be changed while driving,
+ * the strategy is selected for each step and the exploration pose is tracked also if exploration is off.
+ */
+void doExplore(BDButton * aTheTouchedButton, int16_t aValue) {
+    sUseExploration = aValue;
+}
+
+/*
+ * Switches wall following on and off. Can be changed while driving.
+ */
+void doWallFollowing(BDButton * aTheTouchedButton, int16_t aValue) {
+    sUseWallFollowing = aValue;
+}
+
 void startStopAutomomousDrive(bool aDoStart, bool aDoInternalAutonomousDrive) {
     sRunAutonomousDrive = aDoStart;
     sUseBuiltInAutonomousDriveStrategy = aDoInternalAutonomousDrive;
@@ -108,6 +134,17 @@ void startStopAutomomousDrive(bool aDoStart, bool aDoInternalAutonomousDrive) {
         }
         sDoStep = true;
         resetPathData();
+        resetTimeToCollision();
+        resetExploration();
+        resetScanMatching();
+        resetWallFollowing();
+#if defined(USE_PHONE_HEADING_FUSION) || defined(USE_MPU6050_GYRO)
+        startHeadingFusion();
+#endif
+    }
+    if (!aDoStart) {
+        stopNavigation();
+        stopHeadingFusion();
     }
     TouchButtonBuiltInAutonomousDrive.setValue(tInternalAutonomousDrive, (sActualPage == PAGE_AUTOMATIC_CONTROL));
     TouchButtonTestUser.setValue(tExternalAutonomousDrive, (sActualPage == PAGE_AUTOMATIC_CONTROL));
@@ -155,6 +192,12 @@ void initAutonomousDrivePage(void) {
             sRunAutonomousDrive && !sUseBuiltInAutonomousDriveStrategy, &doStartStopTestUser);
     TouchButtonTestUser.setCaptionForValueTrue(F("Stop\nUser"));
 
+    TouchButtonExplore.init(BUTTON_WIDTH_10_POS_4, 0, BUTTON_WIDTH_3_5, BUTTON_HEIGHT_8, COLOR_RED, F("Explore"), TEXT_SIZE_11,
+            FLAG_BUTTON_DO_BEEP_ON_TOUCH | FLAG_BUTTON_TYPE_TOGGLE_RED_GREEN, sUseExploration, &doExplore);
+
+    TouchButtonWallFollowing.init(BUTTON_WIDTH_10_POS_7, 0, BUTTON_WIDTH_6, BUTTON_HEIGHT_8, COLOR_RED, F("Wall"), TEXT_SIZE_11,
+            FLAG_BUTTON_DO_BEEP_ON_TOUCH | FLAG_BUTTON_TYPE_TOGGLE_RED_GREEN, sUseWallFollowing, &doWallFollowing);
+
 }
 
 void drawAutonomousDrivePage(void) {
@@ -171,6 +214,8 @@ void drawAutonomousDrivePage(void) {
 
     TouchButtonBuiltInAutonomousDrive.drawButton();
     TouchButtonTestUser.drawButton();
+    TouchButtonExplore.drawButton();
+    TouchButtonWallFollowing.drawButton();
     TouchButtonNextPage.drawButton();
 
     drawForwardDistancesInfos();
@@ -0,0 +1,126 @@
+/*
+ * DistanceFilter.cpp
+ *
+ * Keeps the last DISTANCE_HISTORY_SIZE distances for each sweep index.
+ * If the car drives straight on, the history is shifted by the driven distance projected on the direction of each index.
+ * The median of the history is stored in sFilteredDistancesArray, which is the input for doWallDetection().
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <Arduino.h>
+
+#include "DistanceFilter.h"
+
+uint8_t sFilteredDistancesArray[NUMBER_OF_DISTANCES];
+
+uint8_t sDistanceHistory[NUMBER_OF_DISTANCES][DISTANCE_HISTORY_SIZE]; // index 0 is the newest value
+
+/*
+ * sin() * 256 of the sweep angles 10, 28, 46 ... 172 degrees
+ */
+const uint8_t SweepSinus256[NUMBER_OF_DISTANCES] PROGMEM = { 44, 120, 184, 230, 254, 252, 226, 178, 112, 36 };
+
+uint8_t getSweepSinus256(uint8_t aIndex) {
+    return pgm_read_byte(&SweepSinus256[aIndex]);
+}
+
+/*
+ * The sweep angles of index and index + 5 differ by 90 degrees
+ */
+uint8_t getSweepCosinus256(uint8_t aIndex) {
+    return pgm_read_byte(&SweepSinus256[(aIndex + (NUMBER_OF_DISTANCES / 2)) % NUMBER_OF_DISTANCES]);
+}
+
+/*
+ * The filtered values are set to the last raw values, so no median of the old history survives for indexes,
+ * which are not measured by the next sweep.
+ */
+void resetDistanceHistory() {
+    memset(sDistanceHistory, DISTANCE_HISTORY_EMPTY, sizeof(sDistanceHistory));
+    memcpy(sFilteredDistancesArray, sForwardDistancesInfo.RawDistancesArray, NUMBER_OF_DISTANCES);
+}
+
+/*
+ * Obstacles come nearer by aDrivenCentimeter * sin(angle). Timeout values are left unchanged.
+ */
+void compensateDistanceHistory(uint8_t aDrivenCentimeter) {
+    for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+        uint8_t tDelta = ((uint16_t) aDrivenCentimeter * pgm_read_byte(&SweepSinus256[i])) >> 8;
+        for (uint8_t j = 0; j < DISTANCE_HISTORY_SIZE; ++j) {
+            uint8_t tDistance = sDistanceHistory[i][j];
+            if (tDistance != DISTANCE_HISTORY_EMPTY && tDistance < US_TIMEOUT_CENTIMETER) {
+                if (tDistance > tDelta) {
+                    sDistanceHistory[i][j] = tDistance - tDelta;
+                } else {
+                    sDistanceHistory[i][j] = 0;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Median of 3 values, minimum of 2 values, to be on the safe side
+ */
+static uint8_t getHistoryMedian(uint8_t aIndex) {
+    uint8_t *tHistory = sDistanceHistory[aIndex];
+    uint8_t a = tHistory[0];
+    uint8_t b = tHistory[1];
+    uint8_t c = tHistory[2];
+    if (b == DISTANCE_HISTORY_EMPTY) {
+        return a;
+    }
+    if (c == DISTANCE_HISTORY_EMPTY) {
+        return min(a, b);
+    }
+    if (a > b) {
+        uint8_t t = a;
+        a = b;
+        b = t;
+    }
+    // now a <= b
+    if (c <= a) {
+        return a;
+    }
+    if (c >= b) {
+        return b;
+    }
+    return c;
+}
+
+/*
+ * Hampel like check against the median of the history. Returns false if history is empty.
+ */
+bool isDistanceOutlier(uint8_t aIndex, uint8_t aDistance) {
+    if (sDistanceHistory[aIndex][0] == DISTANCE_HISTORY_EMPTY) {
+        return false;
+    }
+    uint8_t tMedian = getHistoryMedian(aIndex);
+    uint8_t tThreshold = tMedian / 4;
+    if (tThreshold < DISTANCE_OUTLIER_CENTIMETER) {
+        tThreshold = DISTANCE_OUTLIER_CENTIMETER;
+    }
+    return abs((int) aDistance - (int) tMedian) > tThreshold;
+}
+
+/*
+ * Returns the new filtered value
+ */
+uint8_t addToDistanceHistory(uint8_t aIndex, uint8_t aDistance) {
+    uint8_t *tHistory = sDistanceHistory[aIndex];
+    for (uint8_t j = DISTANCE_HISTORY_SIZE - 1; j > 0; --j) {
+        tHistory[j] = tHistory[j - 1];
+    }
+    tHistory[0] = aDistance;
+    sFilteredDistancesArray[aIndex] = getHistoryMedian(aIndex);
+    return sFilteredDistancesArray[aIndex];
+}
+
+/*
+ * For a change confirmed by a second ping. Otherwise the median would return the old value until the next sweep.
+ */
+void setDistanceHistory(uint8_t aIndex, uint8_t aDistance) {
+    memset(sDistanceHistory[aIndex], aDistance, DISTANCE_HISTORY_SIZE);
+    sFilteredDistancesArray[aIndex] = aDistance;
+}
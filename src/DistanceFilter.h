@@ -0,0 +1,31 @@
+/*
+ * DistanceFilter.h
+ *
+ *  Per angle history of the last US distances with median filter and outlier detection.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SRC_DISTANCEFILTER_H_
+#define SRC_DISTANCEFILTER_H_
+
+#include <stdint.h>
+#include "AutonomousDrive.h"
+
+#define DISTANCE_HISTORY_SIZE 3
+#define DISTANCE_HISTORY_EMPTY 0xFF
+// a sample is an outlier if it differs more than this or more than 1/4 of the median of its history
+#define DISTANCE_OUTLIER_CENTIMETER 15
+
+extern uint8_t sFilteredDistancesArray[NUMBER_OF_DISTANCES];
+
+uint8_t getSweepSinus256(uint8_t aIndex);
+uint8_t getSweepCosinus256(uint8_t aIndex); // absolute value
+
+void resetDistanceHistory();
+void compensateDistanceHistory(uint8_t aDrivenCentimeter);
+bool isDistanceOutlier(uint8_t aIndex, uint8_t aDistance);
+uint8_t addToDistanceHistory(uint8_t aIndex, uint8_t aDistance);
+void setDistanceHistory(uint8_t aIndex, uint8_t aDistance);
+
+#endif /* SRC_DISTANCEFILTER_H_ */
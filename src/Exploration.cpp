@@ -0,0 +1,268 @@
+/*
+ * Exploration.cpp
+ *
+ * Contains:
+ * updateExplorationMap(): Marks the cells along each sweep vector as free and the cell at its end as occupied.
+ * computeExplorationGoal(): Finds the nearest frontier i.e. a free cell next to an unknown one.
+ * doExplorationCollisionDetection(): Built in collision detection, but turning to the clear direction nearest to the frontier.
+ *
+ * The pose of the car is taken from the odometer of the wheels and the requested turns.
+ * The map is not scrolled continuously, it is shifted by whole cells if the car comes near its border.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <Arduino.h>
+#include <EncoderMotor.h>
+
+#include "Exploration.h"
+#include "AutonomousDrive.h"
+#include "RobotCar.h"
+
+bool sUseExploration = false;
+bool sExplorationHasGoal;
+int16_t sExplorationGoalDegrees;
+uint16_t sExplorationFreeCellCount;
+
+uint8_t sExplorationMap[(EXPLORATION_MAP_SIZE * EXPLORATION_MAP_SIZE) / 4]; // 4 cells per byte
+
+float sExplorationCarX;
+float sExplorationCarY;
+int16_t sExplorationCarHeadingDegrees;
+int16_t sExplorationEncoderPosition; // of last pose update
+int16_t sExplorationMapShiftX;
+int16_t sExplorationMapShiftY;
+
+void resetExploration() {
+    memset(sExplorationMap, 0, sizeof(sExplorationMap));
+    sExplorationCarX = (EXPLORATION_MAP_SIZE * EXPLORATION_CELL_CENTIMETER) / 2;
+    sExplorationCarY = (EXPLORATION_MAP_SIZE * EXPLORATION_CELL_CENTIMETER) / 2;
+    sExplorationCarHeadingDegrees = 0;
+    sExplorationEncoderPosition = getEncoderPositionSum();
+    sExplorationMapShiftX = 0;
+    sExplorationMapShiftY = 0;
+    sExplorationHasGoal = false;
+    sExplorationFreeCellCount = 0;
+}
+
+/*
+ * Returns EXPLORATION_CELL_UNKNOWN for cells outside the map
+ */
+uint8_t getExplorationCellWithCounter(int8_t aX, int8_t aY) {
+    if (aX < 0 || aX >= EXPLORATION_MAP_SIZE || aY < 0 || aY >= EXPLORATION_MAP_SIZE) {
+        return EXPLORATION_CELL_UNKNOWN;
+    }
+    uint8_t tIndex = (aY * EXPLORATION_MAP_SIZE) + aX;
+    return (sExplorationMap[tIndex >> 2] >> ((tIndex & 0x03) * 2)) & 0x03;
+}
+
+uint8_t getExplorationCell(int8_t aX, int8_t aY) {
+    uint8_t tCell = getExplorationCellWithCounter(aX, aY);
+    if (tCell == EXPLORATION_CELL_OCCUPIED_CONFIRMED) {
+        return EXPLORATION_CELL_OCCUPIED;
+    }
+    return tCell;
+}
+
+void setExplorationCell(int8_t aX, int8_t aY, uint8_t aValue) {
+    if (aX < 0 || aX >= EXPLORATION_MAP_SIZE || aY < 0 || aY >= EXPLORATION_MAP_SIZE) {
+        return;
+    }
+    uint8_t tIndex = (aY * EXPLORATION_MAP_SIZE) + aX;
+    uint8_t tShift = (tIndex & 0x03) * 2;
+    sExplorationMap[tIndex >> 2] = (sExplorationMap[tIndex >> 2] & ~(0x03 << tShift)) | (aValue << tShift);
+}
+
+/*
+ * Move the content of the map by aDeltaX and aDeltaY cells towards the origin
+ */
+void shiftExplorationMap(int8_t aDeltaX, int8_t aDeltaY) {
+    for (uint8_t j = 0; j < EXPLORATION_MAP_SIZE; ++j) {
+        // copy in a direction, which does not overwrite cells still to be copied
+        int8_t y = (aDeltaY >= 0) ? j : (EXPLORATION_MAP_SIZE - 1 - j);
+        for (uint8_t i = 0; i < EXPLORATION_MAP_SIZE; ++i) {
+            int8_t x = (aDeltaX >= 0) ? i : (EXPLORATION_MAP_SIZE - 1 - i);
+            setExplorationCell(x, y, getExplorationCellWithCounter(x + aDeltaX, y + aDeltaY));
+        }
+    }
+}
+
+/*
+ * Integrate the distance driven since last call.
+ * The pose is always updated, even if neither exploration nor navigation is active,
+ * since both can be switched on while driving.
+ */
+void updateExplorationPose() {
+    int16_t tEncoderPosition = getEncoderPositionSum();
+    // sum of both wheels
+    float tCentimeter = (tEncoderPosition - sExplorationEncoderPosition) / (2.0 * FACTOR_CENTIMETER_TO_COUNT);
+    sExplorationEncoderPosition = tEncoderPosition;
+    float tRadian = sExplorationCarHeadingDegrees * (M_PI / 180);
+    sExplorationCarX += cos(tRadian) * tCentimeter;
+    sExplorationCarY += sin(tRadian) * tCentimeter;
+
+    /*
+     * Shift map to have the car in the middle again
+     */
+    int8_t tCarCellX = sExplorationCarX / EXPLORATION_CELL_CENTIMETER;
+    int8_t tCarCellY = sExplorationCarY / EXPLORATION_CELL_CENTIMETER;
+    if (tCarCellX < EXPLORATION_BORDER_CELLS || tCarCellX >= EXPLORATION_MAP_SIZE - EXPLORATION_BORDER_CELLS
+            || tCarCellY < EXPLORATION_BORDER_CELLS || tCarCellY >= EXPLORATION_MAP_SIZE - EXPLORATION_BORDER_CELLS) {
+        int8_t tDeltaX = tCarCellX - (EXPLORATION_MAP_SIZE / 2);
+        int8_t tDeltaY = tCarCellY - (EXPLORATION_MAP_SIZE / 2);
+        shiftExplorationMap(tDeltaX, tDeltaY);
+        sExplorationMapShiftX += tDeltaX;
+        sExplorationMapShiftY += tDeltaY;
+        sExplorationCarX -= tDeltaX * EXPLORATION_CELL_CENTIMETER;
+        sExplorationCarY -= tDeltaY * EXPLORATION_CELL_CENTIMETER;
+    }
+}
+
+/*
+ * To be called before the car rotates
+ * @param  aRotationDegrees positive -> turn left, negative -> turn right
+ */
+void rotateExplorationPose(int aRotationDegrees) {
+    updateExplorationPose();
+    sExplorationCarHeadingDegrees = (sExplorationCarHeadingDegrees + aRotationDegrees + 360) % 360;
+}
+
+/*
+ * Uses RawDistancesArray of the last sweep.
+ * Without echo, the cells are only free up to the horizon used for the measurement, not up to US_TIMEOUT_CENTIMETER.
+ */
+void updateExplorationMap() {
+    updateExplorationPose();
+    for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+        unsigned int tDistance = sForwardDistancesInfo.RawDistancesArray[i];
+        bool tIsObstacle = (tDistance < US_TIMEOUT_CENTIMETER);
+        if (!tIsObstacle) {
+            tDistance = sUSHorizonArray[i];
+        }
+        float tRadian = (sExplorationCarHeadingDegrees + (10 + (i * SWEEP_DEGREES_PER_INDEX)) - 90) * (M_PI / 180);
+        float tCos = cos(tRadian);
+        float tSin = sin(tRadian);
+        int8_t tObstacleX = (sExplorationCarX + (tCos * tDistance)) / EXPLORATION_CELL_CENTIMETER;
+        int8_t tObstacleY = (sExplorationCarY + (tSin * tDistance)) / EXPLORATION_CELL_CENTIMETER;
+        int8_t tLastX = -1;
+        int8_t tLastY = -1;
+        for (unsigned int tRadius = EXPLORATION_CELL_CENTIMETER / 2; tRadius < tDistance; tRadius += EXPLORATION_CELL_CENTIMETER / 2) {
+            int8_t tX = (sExplorationCarX + (tCos * tRadius)) / EXPLORATION_CELL_CENTIMETER;
+            int8_t tY = (sExplorationCarY + (tSin * tRadius)) / EXPLORATION_CELL_CENTIMETER;
+            // count each cell only once per ray and not the cell of the echo
+            if ((tX == tLastX && tY == tLastY) || (tIsObstacle && tX == tObstacleX && tY == tObstacleY)) {
+                continue;
+            }
+            tLastX = tX;
+            tLastY = tY;
+            uint8_t tCell = getExplorationCellWithCounter(tX, tY);
+            if (tCell == EXPLORATION_CELL_UNKNOWN || tCell == EXPLORATION_CELL_OCCUPIED) {
+                setExplorationCell(tX, tY, EXPLORATION_CELL_FREE);
+            } else if (tCell == EXPLORATION_CELL_OCCUPIED_CONFIRMED) {
+                setExplorationCell(tX, tY, EXPLORATION_CELL_OCCUPIED);
+            }
+        }
+        if (tIsObstacle) {
+            uint8_t tCell = getExplorationCellWithCounter(tObstacleX, tObstacleY);
+            setExplorationCell(tObstacleX, tObstacleY,
+                    (tCell >= EXPLORATION_CELL_OCCUPIED) ? EXPLORATION_CELL_OCCUPIED_CONFIRMED : EXPLORATION_CELL_OCCUPIED);
+        }
+    }
+}
+
+/*
+ * Sets sExplorationGoalDegrees to the direction of the nearest frontier.
+ * Returns false if there is no frontier.
+ */
+bool computeExplorationGoal() {
+    int8_t tCarCellX = sExplorationCarX / EXPLORATION_CELL_CENTIMETER;
+    int8_t tCarCellY = sExplorationCarY / EXPLORATION_CELL_CENTIMETER;
+    uint16_t tMinSquareDistance = 0xFFFF;
+    int8_t tGoalDeltaX = 0;
+    int8_t tGoalDeltaY = 0;
+    sExplorationFreeCellCount = 0;
+
+    for (int8_t y = 0; y < EXPLORATION_MAP_SIZE; ++y) {
+        for (int8_t x = 0; x < EXPLORATION_MAP_SIZE; ++x) {
+            if (getExplorationCell(x, y) != EXPLORATION_CELL_FREE) {
+                continue;
+            }
+            sExplorationFreeCellCount++;
+            if (getExplorationCell(x + 1, y) == EXPLORATION_CELL_UNKNOWN || getExplorationCell(x - 1, y) == EXPLORATION_CELL_UNKNOWN
+                    || getExplorationCell(x, y + 1) == EXPLORATION_CELL_UNKNOWN
+                    || getExplorationCell(x, y - 1) == EXPLORATION_CELL_UNKNOWN) {
+                int8_t tDeltaX = x - tCarCellX;
+                int8_t tDeltaY = y - tCarCellY;
+                uint16_t tSquareDistance = (tDeltaX * tDeltaX) + (tDeltaY * tDeltaY);
+                if (tSquareDistance >= (EXPLORATION_MIN_FRONTIER_CELLS * EXPLORATION_MIN_FRONTIER_CELLS)
+                        && tSquareDistance < tMinSquareDistance) {
+                    tMinSquareDistance = tSquareDistance;
+                    tGoalDeltaX = tDeltaX;
+                    tGoalDeltaY = tDeltaY;
+                }
+            }
+        }
+    }
+
+    sExplorationHasGoal = (tMinSquareDistance != 0xFFFF);
+    if (sExplorationHasGoal) {
+        sExplorationGoalDegrees = getDegreesToCell(tCarCellX + tGoalDeltaX, tCarCellY + tGoalDeltaY);
+    }
+    return sExplorationHasGoal;
+}
+
+/*
+ * Direction to the center of a cell relative to the actual heading, positive is left
+ */
+int16_t getDegreesToCell(int8_t aX, int8_t aY) {
+    float tDeltaX = ((aX + 0.5) * EXPLORATION_CELL_CENTIMETER) - sExplorationCarX;
+    float tDeltaY = ((aY + 0.5) * EXPLORATION_CELL_CENTIMETER) - sExplorationCarY;
+    int tDegrees = (atan2(tDeltaY, tDeltaX) * (180 / M_PI)) - sExplorationCarHeadingDegrees;
+    if (tDegrees > 180) {
+        tDegrees -= 360;
+    } else if (tDegrees <= -180) {
+        tDegrees += 360;
+    }
+    return tDegrees;
+}
+
+/*
+ * Modifies the decision of doBuiltInCollisionDetection() to get nearer to a goal.
+ * A clear direction nearer to the goal is taken, if it is nearer than the decision.
+ * A free way ahead is left only if the goal is more than EXPLORATION_MIN_TURN_DEGREES off.
+ */
+int getTurnTowardsGoal(int aDegreesToTurn, int16_t aGoalDegrees) {
+    if (aDegreesToTurn == 180 || aDegreesToTurn == GO_BACK_AND_SCAN_AGAIN) {
+        return aDegreesToTurn;
+    }
+    if (aDegreesToTurn == 0 && abs(aGoalDegrees) <= EXPLORATION_MIN_TURN_DEGREES) {
+        return 0;
+    }
+    int tBestDeviation = (aDegreesToTurn == 0) ? abs(aGoalDegrees) : 360;
+    for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+        if (sForwardDistancesInfo.ProcessedDistancesArray[i] > sCountPerScan) {
+            int tIndexDegrees = (i * DEGREES_PER_STEP) - 90;
+            int tDeviation = abs(tIndexDegrees - aGoalDegrees);
+            if (tDeviation < tBestDeviation) {
+                tBestDeviation = tDeviation;
+                aDegreesToTurn = tIndexDegrees;
+            }
+        }
+    }
+    return aDegreesToTurn;
+}
+
+/*
+ * Checks distances and returns degree to turn
+ * 0 -> no turn, >0 -> turn left, <0 -> turn right
+ * Like doBuiltInCollisionDetection(), but if there is a clear direction nearer to the frontier, it is taken instead.
+ */
+int doExplorationCollisionDetection() {
+    updateExplorationMap();
+    computeExplorationGoal();
+    int tDegreesToTurn = doBuiltInCollisionDetection();
+    if (!sExplorationHasGoal) {
+        return tDegreesToTurn;
+    }
+    return getTurnTowardsGoal(tDegreesToTurn, sExplorationGoalDegrees);
+}
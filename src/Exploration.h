@@ -0,0 +1,58 @@
+/*
+ * Exploration.h
+ *
+ *  Frontier based exploration. A compact map of unknown, free and occupied cells is built from the sweeps and odometry.
+ *  The nearest frontier is used as goal for the turn decisions of the built in collision detection.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SRC_EXPLORATION_H_
+#define SRC_EXPLORATION_H_
+
+#include <stdint.h>
+
+#define EXPLORATION_CELL_UNKNOWN 0
+#define EXPLORATION_CELL_FREE 1
+#define EXPLORATION_CELL_OCCUPIED 2
+/*
+ * Hit and miss counter: A cell hit once is OCCUPIED, hit again it is OCCUPIED_CONFIRMED.
+ * Each free observation decrements it, so a single transient echo is cleared by the next free observation and a wall by two.
+ * OCCUPIED_CONFIRMED is only used internally, getExplorationCell() returns EXPLORATION_CELL_OCCUPIED for it.
+ */
+#define EXPLORATION_CELL_OCCUPIED_CONFIRMED 3
+
+// 16 * 16 cells with 2 bit each => 64 bytes for 4 * 4 meter
+#define EXPLORATION_MAP_SIZE 16
+#define EXPLORATION_CELL_CENTIMETER 25
+// the map is shifted, if the car comes nearer than this to its border
+#define EXPLORATION_BORDER_CELLS 3
+// frontiers nearer than this are just being explored
+#define EXPLORATION_MIN_FRONTIER_CELLS 2
+// a free way ahead is left for the frontier only if the frontier is more than this off
+#define EXPLORATION_MIN_TURN_DEGREES 45
+
+extern bool sUseExploration;
+extern bool sExplorationHasGoal;
+extern int16_t sExplorationGoalDegrees; // relative to the actual heading, positive is left
+extern uint16_t sExplorationFreeCellCount;
+
+// pose of the car in centimeter from the lower left corner of the map, 0 degree is x direction
+extern float sExplorationCarX;
+extern float sExplorationCarY;
+extern int16_t sExplorationCarHeadingDegrees;
+// number of cells the map was shifted since reset
+extern int16_t sExplorationMapShiftX;
+extern int16_t sExplorationMapShiftY;
+
+void resetExploration();
+void updateExplorationPose();
+void rotateExplorationPose(int aRotationDegrees);
+uint8_t getExplorationCell(int8_t aX, int8_t aY);
+void updateExplorationMap();
+bool computeExplorationGoal();
+int16_t getDegreesToCell(int8_t aX, int8_t aY);
+int getTurnTowardsGoal(int aDegreesToTurn, int16_t aGoalDegrees);
+int doExplorationCollisionDetection();
+
+#endif /* SRC_EXPLORATION_H_ */
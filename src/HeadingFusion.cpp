@@ -0,0 +1,198 @@
+/*
+ * HeadingFusion.cpp
+ *
+ * Complementary filter for the heading in fixed point.
+ * The yaw from the encoders is integrated to an absolute encoder heading. At each gyroscope event, the integrated gyroscope yaw
+ * is added to the fused heading, which is then pulled by 1 / 2^HEADING_FUSION_ENCODER_WEIGHT_SHIFT of its difference
+ * towards the encoder heading. So the gyroscope determines the short term changes, e.g. in turns where the wheels slip,
+ * and its drift is bounded by the encoder heading. While the car is stopped, only the gyroscope bias is learned.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <Arduino.h>
+
+#include "HeadingFusion.h"
+#include "RobotCar.h"
+#ifdef USE_MPU6050_GYRO
+#include <MPU6050.h>
+#endif
+
+bool sHeadingFusionIsActive = false;
+uint16_t sFusedHeading16;
+int16_t sGyroBias16;
+// sGyroBias16 * 2^HEADING_FUSION_BIAS_SHIFT. The fraction bits let the low pass follow errors below 1 degree per second.
+long sGyroBiasSum;
+
+uint16_t sEncoderHeading16; // 0 to HEADING_FUSION_FULL_CIRCLE - 1, integrated encoder yaw
+
+unsigned long sLastGyroEventMillis;
+int16_t sEncoderYawPending16; // encoder yaw since the last gyroscope event
+int16_t sHeadingFusionRightPosition;
+int16_t sHeadingFusionLeftPosition;
+uint16_t sTurnStartHeading16;
+int16_t sTurnExpectedRotationDegrees;
+
+uint16_t addToHeading(uint16_t aHeading16, int16_t aDelta16) {
+    int16_t tHeading16 = (int16_t) aHeading16 + aDelta16;
+    while (tHeading16 < 0) {
+        tHeading16 += HEADING_FUSION_FULL_CIRCLE;
+    }
+    while (tHeading16 >= HEADING_FUSION_FULL_CIRCLE) {
+        tHeading16 -= HEADING_FUSION_FULL_CIRCLE;
+    }
+    return tHeading16;
+}
+
+void addToFusedHeading(int16_t aDelta16) {
+    sFusedHeading16 = addToHeading(sFusedHeading16, aDelta16);
+}
+
+/*
+ * Yaw since the last call. An in place turn by 1 degree is a difference of the wheel counts of 1 turn factor.
+ */
+int16_t getEncoderYaw16() {
+    noInterrupts();
+    int16_t tRightPosition = rightEncoderMotor.EncoderPosition;
+    int16_t tLeftPosition = leftEncoderMotor.EncoderPosition;
+    interrupts();
+    int16_t tCountDifference = (tRightPosition - sHeadingFusionRightPosition) - (tLeftPosition - sHeadingFusionLeftPosition);
+    sHeadingFusionRightPosition = tRightPosition;
+    sHeadingFusionLeftPosition = tLeftPosition;
+    uint16_t tFactor = (RobotCar.TurnFactors[TURN_FACTOR_LEFT_SLOW] + RobotCar.TurnFactors[TURN_FACTOR_RIGHT_SLOW]) / 2;
+    return ((long) tCountDifference * TURN_FACTOR_SCALE * HEADING_FUSION_FRACTION) / tFactor;
+}
+
+void resetHeadingFusion() {
+    getEncoderYaw16();
+    sFusedHeading16 = 0;
+    sEncoderHeading16 = 0;
+    sEncoderYawPending16 = 0;
+}
+
+/*
+ * The complementary filter
+ */
+void fuseGyroYaw(int16_t aGyroYaw16) {
+    addToFusedHeading(aGyroYaw16);
+    // difference to the encoder heading within +/-180 degree
+    int16_t tError16 = (int16_t) sEncoderHeading16 - (int16_t) sFusedHeading16;
+    if (tError16 >= HEADING_FUSION_FULL_CIRCLE / 2) {
+        tError16 -= HEADING_FUSION_FULL_CIRCLE;
+    } else if (tError16 < -(HEADING_FUSION_FULL_CIRCLE / 2)) {
+        tError16 += HEADING_FUSION_FULL_CIRCLE;
+    }
+    addToFusedHeading(tError16 / (1 << HEADING_FUSION_ENCODER_WEIGHT_SHIFT));
+    sEncoderYawPending16 = 0;
+}
+
+void handleGyroscopeEvent(uint8_t aSensorType, struct SensorCallback * aSensorCallbackInfo) {
+    bool tWasValid = isHeadingFusionValid();
+    updateHeadingFusion();
+    unsigned long tMillis = millis();
+    int16_t tRate16 = PHONE_YAW_RATE(aSensorCallbackInfo) * (RAD_TO_DEG * HEADING_FUSION_FRACTION);
+
+    if (RobotCar.isStopped() && sEncoderYawPending16 == 0) {
+        sGyroBiasSum += tRate16 - sGyroBias16;
+        sGyroBias16 = sGyroBiasSum / (1 << HEADING_FUSION_BIAS_SHIFT);
+    } else if (tWasValid) {
+        fuseGyroYaw(((long) (tRate16 - sGyroBias16) * (tMillis - sLastGyroEventMillis)) / 1000);
+    }
+    sEncoderYawPending16 = 0;
+    sLastGyroEventMillis = tMillis;
+}
+
+void startHeadingFusion() {
+    resetHeadingFusion();
+    sLastGyroEventMillis = 0;
+#ifdef USE_MPU6050_GYRO
+    sHeadingFusionIsActive = sIMUIsInitialized;
+    resetIMUFifo();
+    getIMUYawDelta16();
+#else
+    sHeadingFusionIsActive = true;
+    registerSensorChangeCallback(FLAG_SENSOR_TYPE_GYROSCOPE, HEADING_FUSION_SENSOR_RATE, FLAG_SENSOR_NO_FILTER,
+            &handleGyroscopeEvent);
+#endif
+}
+
+void stopHeadingFusion() {
+    if (sHeadingFusionIsActive) {
+        sHeadingFusionIsActive = false;
+#ifndef USE_MPU6050_GYRO
+        registerSensorChangeCallback(FLAG_SENSOR_TYPE_GYROSCOPE, HEADING_FUSION_SENSOR_RATE, FLAG_SENSOR_NO_FILTER, NULL);
+#endif
+    }
+}
+
+/*
+ * False if the phone or the MPU-6050 sends no gyroscope samples, or the bias of the MPU-6050 is not yet learned
+ */
+bool isHeadingFusionValid() {
+    return sHeadingFusionIsActive && sLastGyroEventMillis != 0 && millis() - sLastGyroEventMillis < HEADING_FUSION_TIMEOUT_MILLIS;
+}
+
+/*
+ * To be called before reading the heading and at least every 300 ms for the MPU-6050.
+ * Without gyroscope samples the encoder yaw is used directly.
+ */
+void updateHeadingFusion() {
+    bool tWasValid = isHeadingFusionValid();
+    int16_t tEncoderYaw16 = getEncoderYaw16();
+    sEncoderHeading16 = addToHeading(sEncoderHeading16, tEncoderYaw16);
+    if (tWasValid) {
+        sEncoderYawPending16 += tEncoderYaw16;
+    } else {
+        addToFusedHeading(tEncoderYaw16);
+    }
+#ifdef USE_MPU6050_GYRO
+    if (sHeadingFusionIsActive && updateIMU(RobotCar.isStopped()) > 0) {
+        // the gyroscope yaw since the last valid sample is unknown
+        int16_t tGyroYaw16 = getIMUYawDelta16();
+        // without bias the samples are not valid, they are only used to learn it at standstill
+        if (sIMUBiasIsValid) {
+            if (tWasValid) {
+                fuseGyroYaw(tGyroYaw16);
+            }
+            sLastGyroEventMillis = millis();
+        }
+    }
+#endif
+}
+
+/*
+ * 0 to 359, positive is left
+ */
+int16_t getFusedHeadingDegrees() {
+    updateHeadingFusion();
+    return ((sFusedHeading16 + (HEADING_FUSION_FRACTION / 2)) / HEADING_FUSION_FRACTION) % 360;
+}
+
+/*
+ * The expected rotation is required to resolve rotations of 180 degree and more
+ */
+void markHeadingFusionTurnStart(int16_t aExpectedRotationDegrees) {
+    updateHeadingFusion();
+    sTurnStartHeading16 = sFusedHeading16;
+    sTurnExpectedRotationDegrees = aExpectedRotationDegrees;
+}
+
+/*
+ * Rotation since markHeadingFusionTurnStart() within +/-180 degree of the expected rotation
+ */
+bool getFusedRealRotationDegrees(int16_t * aRealRotationDegrees) {
+    if (!isHeadingFusionValid()) {
+        return false;
+    }
+    updateHeadingFusion();
+    int16_t tRotationDegrees = ((int16_t) (sFusedHeading16 - sTurnStartHeading16) + (HEADING_FUSION_FRACTION / 2))
+            / HEADING_FUSION_FRACTION;
+    while (tRotationDegrees < sTurnExpectedRotationDegrees - 180) {
+        tRotationDegrees += 360;
+    }
+    while (tRotationDegrees >= sTurnExpectedRotationDegrees + 180) {
+        tRotationDegrees -= 360;
+    }
+    *aRealRotationDegrees = tRotationDegrees;
+    return true;
+}
@@ -0,0 +1,57 @@
+/*
+ * HeadingFusion.h
+ *
+ *  Heading of the car from the gyroscope of the phone running BlueDisplay or a MPU-6050,
+ *  fused with the yaw from the wheel encoders.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SRC_HEADINGFUSION_H_
+#define SRC_HEADINGFUSION_H_
+
+#include <stdint.h>
+#include "RobotCarGui.h"
+
+// headings and rates are in 1/16 degree
+#define HEADING_FUSION_FRACTION 16
+#define HEADING_FUSION_FULL_CIRCLE (360 * HEADING_FUSION_FRACTION)
+
+/*
+ * The sensor events may use a third of the serial bandwidth. One event has appr. 16 bytes.
+ * At 9600 baud this gives 320 bytes/s and therefore the 60 ms rate, at 115200 baud the 20 ms rate is used.
+ */
+#define HEADING_FUSION_BYTES_PER_SENSOR_EVENT 16
+#define HEADING_FUSION_MAX_BYTES_PER_SECOND (HC_05_BAUD_RATE / (10 * 3))
+#if (HEADING_FUSION_BYTES_PER_SENSOR_EVENT * 50) <= HEADING_FUSION_MAX_BYTES_PER_SECOND
+#define HEADING_FUSION_SENSOR_RATE FLAG_SENSOR_DELAY_GAME
+#elif (HEADING_FUSION_BYTES_PER_SENSOR_EVENT * 17) <= HEADING_FUSION_MAX_BYTES_PER_SECOND
+#define HEADING_FUSION_SENSOR_RATE FLAG_SENSOR_DELAY_UI
+#else
+#define HEADING_FUSION_SENSOR_RATE FLAG_SENSOR_DELAY_NORMAL
+#endif
+
+// only the encoders are used, if there was no sensor event for this time
+#define HEADING_FUSION_TIMEOUT_MILLIS 500
+// at each gyroscope sample, the fused heading is pulled by 1 / 2^HEADING_FUSION_ENCODER_WEIGHT_SHIFT towards the encoder heading
+#define HEADING_FUSION_ENCODER_WEIGHT_SHIFT 3
+// low pass for the gyroscope bias, which is learned while the car is stopped
+#define HEADING_FUSION_BIAS_SHIFT 4
+
+// Yaw rate in rad/s, positive is left. The z axis is perpendicular to the screen, which fits for a phone lying screen up on the car.
+#define PHONE_YAW_RATE(aSensorInfo) ((aSensorInfo)->ValueZ)
+
+extern bool sHeadingFusionIsActive;
+extern uint16_t sFusedHeading16; // 0 to HEADING_FUSION_FULL_CIRCLE - 1, 0 is the heading at reset, positive is left
+extern int16_t sGyroBias16; // in 1/16 degree per second
+
+void resetHeadingFusion();
+void startHeadingFusion();
+void stopHeadingFusion();
+bool isHeadingFusionValid();
+void updateHeadingFusion();
+int16_t getFusedHeadingDegrees();
+void markHeadingFusionTurnStart(int16_t aExpectedRotationDegrees);
+bool getFusedRealRotationDegrees(int16_t * aRealRotationDegrees);
+
+#endif /* SRC_HEADINGFUSION_H_ */
@@ -0,0 +1,262 @@
+/*
+ * Navigation.cpp
+ *
+ * Contains:
+ * planNavigationRoute(): A* from the goal cell to the car cell over the exploration map. Occupied cells are blocked,
+ *      unknown cells are assumed to be free. The result is the cost to the goal for each expanded cell.
+ * isNavigationRouteBlocked(): Checks if the route from the actual car cell is still valid.
+ * doNavigationCollisionDetection(): Built in collision detection, but turning towards the route.
+ *
+ * Since the search starts at the goal, the costs stay valid while the car moves along the route
+ * and replanning is only required if a new obstacle is on the route or the car has left the expanded cells.
+ * Open and closed set are bit arrays, the costs are bytes, so all fit into 320 bytes of RAM.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <Arduino.h>
+
+#include "Navigation.h"
+#include "Exploration.h"
+#include "AutonomousDrive.h"
+#include "RobotCarGui.h"
+
+#define NAVIGATION_NUMBER_OF_CELLS (EXPLORATION_MAP_SIZE * EXPLORATION_MAP_SIZE)
+
+bool sNavigationIsActive = false;
+int16_t sNavigationGoalX;
+int16_t sNavigationGoalY;
+uint8_t sNavigationReplanCount;
+
+uint8_t sNavigationCost[NAVIGATION_NUMBER_OF_CELLS]; // cost to goal
+uint8_t sNavigationOpenSet[NAVIGATION_NUMBER_OF_CELLS / 8];
+uint8_t sNavigationClosedSet[NAVIGATION_NUMBER_OF_CELLS / 8];
+bool sNavigationHasRoute;
+
+// the 8 neighbours, straight ones first
+const int8_t NeighbourDeltaX[8] PROGMEM = { 1, 0, -1, 0, 1, -1, -1, 1 };
+const int8_t NeighbourDeltaY[8] PROGMEM = { 0, 1, 0, -1, 1, 1, -1, -1 };
+
+bool isInSet(uint8_t * aSet, uint8_t aCellIndex) {
+    return aSet[aCellIndex >> 3] & (1 << (aCellIndex & 0x07));
+}
+
+void addToSet(uint8_t * aSet, uint8_t aCellIndex) {
+    aSet[aCellIndex >> 3] |= (1 << (aCellIndex & 0x07));
+}
+
+void removeFromSet(uint8_t * aSet, uint8_t aCellIndex) {
+    aSet[aCellIndex >> 3] &= ~(1 << (aCellIndex & 0x07));
+}
+
+/*
+ * @param aGoalX, aGoalY in centimeter from the start of the autonomous drive
+ */
+void setNavigationGoal(int16_t aGoalX, int16_t aGoalY) {
+    sNavigationGoalX = aGoalX;
+    sNavigationGoalY = aGoalY;
+    sNavigationIsActive = true;
+    sNavigationHasRoute = false;
+    sNavigationReplanCount = 0;
+}
+
+void stopNavigation() {
+    sNavigationIsActive = false;
+    sNavigationHasRoute = false;
+}
+
+/*
+ * Floor division, since the goal may be left or below the map
+ */
+int16_t getCellFromCentimeter(int16_t aCentimeter, int16_t aMapShift) {
+    int16_t tMapCentimeter = aCentimeter + ((EXPLORATION_MAP_SIZE * EXPLORATION_CELL_CENTIMETER) / 2)
+            - (aMapShift * EXPLORATION_CELL_CENTIMETER);
+    if (tMapCentimeter < 0) {
+        tMapCentimeter -= EXPLORATION_CELL_CENTIMETER - 1;
+    }
+    return tMapCentimeter / EXPLORATION_CELL_CENTIMETER;
+}
+
+/*
+ * Goals outside of the map are moved to the nearest border cell
+ */
+void getNavigationGoalCell(int8_t * aX, int8_t * aY) {
+    *aX = constrain(getCellFromCentimeter(sNavigationGoalX, sExplorationMapShiftX), 0, EXPLORATION_MAP_SIZE - 1);
+    *aY = constrain(getCellFromCentimeter(sNavigationGoalY, sExplorationMapShiftY), 0, EXPLORATION_MAP_SIZE - 1);
+}
+
+/*
+ * A diagonal step is only allowed if both adjacent straight cells are not occupied
+ */
+bool isNavigationStepAllowed(int8_t aX, int8_t aY, int8_t aDeltaX, int8_t aDeltaY) {
+    int8_t tX = aX + aDeltaX;
+    int8_t tY = aY + aDeltaY;
+    if (tX < 0 || tX >= EXPLORATION_MAP_SIZE || tY < 0 || tY >= EXPLORATION_MAP_SIZE
+            || getExplorationCell(tX, tY) == EXPLORATION_CELL_OCCUPIED) {
+        return false;
+    }
+    if (aDeltaX != 0 && aDeltaY != 0) {
+        return getExplorationCell(tX, aY) != EXPLORATION_CELL_OCCUPIED && getExplorationCell(aX, tY) != EXPLORATION_CELL_OCCUPIED;
+    }
+    return true;
+}
+
+/*
+ * Octile distance in cost units
+ */
+uint8_t getNavigationHeuristic(int8_t aX, int8_t aY, int8_t aTargetX, int8_t aTargetY) {
+    uint8_t tDeltaX = abs(aX - aTargetX);
+    uint8_t tDeltaY = abs(aY - aTargetY);
+    if (tDeltaX > tDeltaY) {
+        return (NAVIGATION_COST_STRAIGHT * tDeltaX) + ((NAVIGATION_COST_DIAGONAL - NAVIGATION_COST_STRAIGHT) * tDeltaY);
+    }
+    return (NAVIGATION_COST_STRAIGHT * tDeltaY) + ((NAVIGATION_COST_DIAGONAL - NAVIGATION_COST_STRAIGHT) * tDeltaX);
+}
+
+/*
+ * A* from goal to car. Costs are clipped at 254, longer routes are not found.
+ * Returns false if there is no route.
+ */
+bool planNavigationRoute() {
+    int8_t tGoalX, tGoalY;
+    getNavigationGoalCell(&tGoalX, &tGoalY);
+    int8_t tCarX = sExplorationCarX / EXPLORATION_CELL_CENTIMETER;
+    int8_t tCarY = sExplorationCarY / EXPLORATION_CELL_CENTIMETER;
+    uint8_t tCarIndex = (tCarY * EXPLORATION_MAP_SIZE) + tCarX;
+
+    memset(sNavigationCost, NAVIGATION_COST_UNKNOWN, sizeof(sNavigationCost));
+    memset(sNavigationOpenSet, 0, sizeof(sNavigationOpenSet));
+    memset(sNavigationClosedSet, 0, sizeof(sNavigationClosedSet));
+    uint8_t tGoalIndex = (tGoalY * EXPLORATION_MAP_SIZE) + tGoalX;
+    sNavigationCost[tGoalIndex] = 0;
+    addToSet(sNavigationOpenSet, tGoalIndex);
+    sNavigationReplanCount++;
+
+    while (true) {
+        /*
+         * Get open cell with lowest cost + heuristic
+         */
+        uint16_t tMinEstimate = 0xFFFF;
+        uint8_t tIndex = 0;
+        for (uint16_t i = 0; i < NAVIGATION_NUMBER_OF_CELLS; ++i) {
+            if (isInSet(sNavigationOpenSet, i)) {
+                uint16_t tEstimate = sNavigationCost[i]
+                        + getNavigationHeuristic(i % EXPLORATION_MAP_SIZE, i / EXPLORATION_MAP_SIZE, tCarX, tCarY);
+                if (tEstimate < tMinEstimate) {
+                    tMinEstimate = tEstimate;
+                    tIndex = i;
+                }
+            }
+        }
+        if (tMinEstimate == 0xFFFF) {
+            sNavigationHasRoute = false;
+            return false;
+        }
+        if (tIndex == tCarIndex) {
+            sNavigationHasRoute = true;
+            return true;
+        }
+        removeFromSet(sNavigationOpenSet, tIndex);
+        addToSet(sNavigationClosedSet, tIndex);
+
+        /*
+         * Expand
+         */
+        int8_t tX = tIndex % EXPLORATION_MAP_SIZE;
+        int8_t tY = tIndex / EXPLORATION_MAP_SIZE;
+        for (uint8_t j = 0; j < 8; ++j) {
+            int8_t tDeltaX = pgm_read_byte(&NeighbourDeltaX[j]);
+            int8_t tDeltaY = pgm_read_byte(&NeighbourDeltaY[j]);
+            if (!isNavigationStepAllowed(tX, tY, tDeltaX, tDeltaY)) {
+                continue;
+            }
+            uint8_t tNeighbourIndex = ((tY + tDeltaY) * EXPLORATION_MAP_SIZE) + tX + tDeltaX;
+            if (isInSet(sNavigationClosedSet, tNeighbourIndex)) {
+                continue;
+            }
+            uint16_t tCost = sNavigationCost[tIndex] + ((j < 4) ? NAVIGATION_COST_STRAIGHT : NAVIGATION_COST_DIAGONAL);
+            if (tCost < sNavigationCost[tNeighbourIndex]) {
+                sNavigationCost[tNeighbourIndex] = tCost;
+                addToSet(sNavigationOpenSet, tNeighbourIndex);
+            }
+        }
+    }
+}
+
+/*
+ * Step to the neighbour with the lowest cost to the goal.
+ * Returns false if there is no neighbour with lower cost i.e. the goal is reached or the cell was not expanded.
+ */
+bool getNextNavigationRouteCell(int8_t * aX, int8_t * aY) {
+    uint8_t tMinCost = sNavigationCost[(*aY * EXPLORATION_MAP_SIZE) + *aX];
+    int8_t tNextX = *aX;
+    int8_t tNextY = *aY;
+    for (uint8_t j = 0; j < 8; ++j) {
+        int8_t tDeltaX = pgm_read_byte(&NeighbourDeltaX[j]);
+        int8_t tDeltaY = pgm_read_byte(&NeighbourDeltaY[j]);
+        if (isNavigationStepAllowed(*aX, *aY, tDeltaX, tDeltaY)) {
+            uint8_t tCost = sNavigationCost[((*aY + tDeltaY) * EXPLORATION_MAP_SIZE) + *aX + tDeltaX];
+            if (tCost < tMinCost) {
+                tMinCost = tCost;
+                tNextX = *aX + tDeltaX;
+                tNextY = *aY + tDeltaY;
+            }
+        }
+    }
+    if (tNextX == *aX && tNextY == *aY) {
+        return false;
+    }
+    *aX = tNextX;
+    *aY = tNextY;
+    return true;
+}
+
+/*
+ * The route is blocked, if a new obstacle prevents following the costs down to the goal
+ */
+bool isNavigationRouteBlocked() {
+    int8_t tX = sExplorationCarX / EXPLORATION_CELL_CENTIMETER;
+    int8_t tY = sExplorationCarY / EXPLORATION_CELL_CENTIMETER;
+    if (!sNavigationHasRoute || sNavigationCost[(tY * EXPLORATION_MAP_SIZE) + tX] == NAVIGATION_COST_UNKNOWN) {
+        return true;
+    }
+    while (sNavigationCost[(tY * EXPLORATION_MAP_SIZE) + tX] != 0) {
+        if (!getNextNavigationRouteCell(&tX, &tY)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Checks distances and returns degree to turn
+ * 0 -> no turn, >0 -> turn left, <0 -> turn right
+ * Stops the autonomous drive if the goal is reached or cannot be reached.
+ */
+int doNavigationCollisionDetection() {
+    updateExplorationMap();
+    int tDegreesToTurn = doBuiltInCollisionDetection();
+
+    int8_t tGoalX, tGoalY;
+    getNavigationGoalCell(&tGoalX, &tGoalY);
+    int8_t tX = sExplorationCarX / EXPLORATION_CELL_CENTIMETER;
+    int8_t tY = sExplorationCarY / EXPLORATION_CELL_CENTIMETER;
+    if (abs(tGoalX - tX) <= NAVIGATION_GOAL_REACHED_CELLS && abs(tGoalY - tY) <= NAVIGATION_GOAL_REACHED_CELLS) {
+        stopNavigation();
+        startStopAutomomousDrive(false, true);
+        return 0;
+    }
+
+    if (isNavigationRouteBlocked() && !planNavigationRoute()) {
+        stopNavigation();
+        startStopAutomomousDrive(false, true);
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < NAVIGATION_LOOK_AHEAD_CELLS; ++i) {
+        if (!getNextNavigationRouteCell(&tX, &tY)) {
+            break;
+        }
+    }
+    return getTurnTowardsGoal(tDegreesToTurn, getDegreesToCell(tX, tY));
+}
@@ -0,0 +1,36 @@
+/*
+ * Navigation.h
+ *
+ *  Drive to a goal tapped on the path page. The route is planned by A* over the cells of the exploration map.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SRC_NAVIGATION_H_
+#define SRC_NAVIGATION_H_
+
+#include <stdint.h>
+
+// cost of a step, the ratio approximates the square root of 2
+#define NAVIGATION_COST_STRAIGHT 2
+#define NAVIGATION_COST_DIAGONAL 3
+#define NAVIGATION_COST_UNKNOWN 0xFF
+// the car heads for the route cell this number of cells ahead
+#define NAVIGATION_LOOK_AHEAD_CELLS 2
+// goal is reached if the car is not more than this number of cells away
+#define NAVIGATION_GOAL_REACHED_CELLS 1
+
+extern bool sNavigationIsActive;
+extern int16_t sNavigationGoalX; // in centimeter from the start of the autonomous drive, 0 degree is x direction
+extern int16_t sNavigationGoalY;
+extern uint8_t sNavigationReplanCount;
+
+void setNavigationGoal(int16_t aGoalX, int16_t aGoalY);
+void stopNavigation();
+void getNavigationGoalCell(int8_t * aX, int8_t * aY);
+bool planNavigationRoute();
+bool getNextNavigationRouteCell(int8_t * aX, int8_t * aY);
+bool isNavigationRouteBlocked();
+int doNavigationCollisionDetection();
+
+#endif /* SRC_NAVIGATION_H_ */
@@ -22,9 +22,18 @@
 
 #include "RobotCarGui.h"
 #include "RobotCar.h"
+#include "Exploration.h"
+#include "Navigation.h"
 
 BDButton TouchButtonResetPath;
 
+// display position of the path origin and scale of last DrawPath() for mapping touch positions to path coordinates
+int sPathOriginDisplayX, sPathOriginDisplayY;
+uint8_t sPathScaleShift;
+
+void drawNavigationRoute();
+void doNavigationTouchDown(struct TouchEvent * aActualPositionPtr);
+
 void doResetPath(BDButton * aTheTouchedButton, int16_t aValue) {
     resetPathData();
     drawPathInfoPage();
@@ -51,9 +60,11 @@ void drawPathInfoPage(void) {
     TouchButtonStep.drawButton();
 
     TouchButtonResetPath.drawButton();
+    drawNavigationRoute();
 }
 
 void startPathInfoPage(void) {
+    registerTouchDownCallback(&doNavigationTouchDown);
     drawPathInfoPage();
 }
 
@@ -62,6 +73,7 @@ void loopPathInfoPage(void) {
 }
 
 void stopPathInfoPage(void) {
+    registerTouchDownCallback(NULL);
     TouchButtonStep.setPosition(0, BUTTON_HEIGHT_4_LINE_3);
 }
 
@@ -77,6 +89,47 @@ int sLastXPathInt, sLastYPathInt;
 int sXPathMax, sXPathMin, sYPathMax, sYPathMin;
 int sLastPathDirectionDegree;
 
+/*
+ * Display position for a position in centimeter from the start of the path
+ */
+int getPathDisplayX(int aCentimeterY) {
+    return sPathOriginDisplayX - ((aCentimeterY * FACTOR_CENTIMETER_TO_COUNT) >> sPathScaleShift);
+}
+int getPathDisplayY(int aCentimeterX) {
+    return sPathOriginDisplayY - ((aCentimeterX * FACTOR_CENTIMETER_TO_COUNT) >> sPathScaleShift);
+}
+
+/*
+ * Draw goal and planned route from the car to the goal
+ */
+void drawNavigationRoute() {
+    if (!sNavigationIsActive) {
+        return;
+    }
+    BlueDisplay1.fillCircle(getPathDisplayX(sNavigationGoalY), getPathDisplayY(sNavigationGoalX), 4, COLOR_BLUE);
+
+    int8_t tX = sExplorationCarX / EXPLORATION_CELL_CENTIMETER;
+    int8_t tY = sExplorationCarY / EXPLORATION_CELL_CENTIMETER;
+    // cell center in centimeter from start of path
+    int tOffsetX = ((sExplorationMapShiftX * EXPLORATION_CELL_CENTIMETER) + (EXPLORATION_CELL_CENTIMETER / 2))
+            - ((EXPLORATION_MAP_SIZE * EXPLORATION_CELL_CENTIMETER) / 2);
+    int tOffsetY = ((sExplorationMapShiftY * EXPLORATION_CELL_CENTIMETER) + (EXPLORATION_CELL_CENTIMETER / 2))
+            - ((EXPLORATION_MAP_SIZE * EXPLORATION_CELL_CENTIMETER) / 2);
+    int tLastDisplayX = getPathDisplayX((tY * EXPLORATION_CELL_CENTIMETER) + tOffsetY);
+    int tLastDisplayY = getPathDisplayY((tX * EXPLORATION_CELL_CENTIMETER) + tOffsetX);
+    // limit steps, if route is not valid
+    for (uint8_t i = 0; i < EXPLORATION_MAP_SIZE * 2; ++i) {
+        if (!getNextNavigationRouteCell(&tX, &tY)) {
+            break;
+        }
+        int tDisplayX = getPathDisplayX((tY * EXPLORATION_CELL_CENTIMETER) + tOffsetY);
+        int tDisplayY = getPathDisplayY((tX * EXPLORATION_CELL_CENTIMETER) + tOffsetX);
+        BlueDisplay1.drawLine(tLastDisplayX, tLastDisplayY, tDisplayX, tDisplayY, COLOR_BLUE);
+        tLastDisplayX = tDisplayX;
+        tLastDisplayY = tDisplayY;
+    }
+}
+
 void resetPathData() {
     sXPathDeltaPtr = &xPathDelta[0];
     sYPathDeltaPtr = &yPathDelta[0];
@@ -164,6 +217,34 @@ void insertToPath(int aLength, int aDegree, bool aAddEntry) {
     }
 }
 
+/*
+ * Tap to go. The touched position is taken as navigation goal.
+ * If not yet running, autonomous drive is started, which resets the path, so the goal is converted relative to the actual car pose.
+ */
+void doNavigationTouchDown(struct TouchEvent * aActualPositionPtr) {
+    // path units are distance counts
+    int tGoalX = ((long) (sPathOriginDisplayY - aActualPositionPtr->TouchPosition.PosY) << sPathScaleShift)
+            / FACTOR_CENTIMETER_TO_COUNT;
+    int tGoalY = ((long) (sPathOriginDisplayX - aActualPositionPtr->TouchPosition.PosX) << sPathScaleShift)
+            / FACTOR_CENTIMETER_TO_COUNT;
+    if (sRunAutonomousDrive) {
+        if (!sUseBuiltInAutonomousDriveStrategy) {
+            return;
+        }
+        setNavigationGoal(tGoalX, tGoalY);
+    } else {
+        float tDeltaX = tGoalX - (sLastXPathInt / FACTOR_CENTIMETER_TO_COUNT);
+        float tDeltaY = tGoalY - (sLastYPathInt / FACTOR_CENTIMETER_TO_COUNT);
+        float tRadian = sLastPathDirectionDegree * (M_PI / 180);
+        float tCos = cos(tRadian);
+        float tSin = sin(tRadian);
+        // set goal before start, since it activates the map
+        setNavigationGoal((tDeltaX * tCos) + (tDeltaY * tSin), (tDeltaY * tCos) - (tDeltaX * tSin));
+        startStopAutomomousDrive(true, true);
+    }
+    drawPathInfoPage();
+}
+
 /*
  * Draw so that (forward) x direction is mapped to display y value since we have landscape layout
  * y+ is left y- is right
@@ -193,6 +274,9 @@ void DrawPath() {
         tXDisplayPos = (sYPathMax >> tScaleShift) + 2; // +2 for left border
     }
     int tYDisplayPos = DISPLAY_HEIGHT + (sXPathMin >> tScaleShift);
+    sPathOriginDisplayX = tXDisplayPos;
+    sPathOriginDisplayY = tYDisplayPos;
+    sPathScaleShift = tScaleShift;
 
     /*
      * Draw Path -> map path x to display y
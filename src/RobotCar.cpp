@@ -22,12 +22,20 @@
 
 #include <digitalWriteFast.h>
 #include <EncoderMotor.h>
+#include <MotorInfoStorage.h>
 #include <HCSR04.h>
 
 #include "AutonomousDrive.h"
 
 #include "RobotCar.h"
 #include "RobotCarGui.h"
+#include "Exploration.h"
+#include "Navigation.h"
+#include "WallFollowing.h"
+#ifdef USE_MPU6050_GYRO
+#include <Wire.h>
+#include <MPU6050.h>
+#endif
 
 #ifdef USE_TB6612_BREAKOUT_BOARD
 #include <PlayRtttl.h>
@@ -54,6 +62,12 @@ void setup() {
     pinMode(TRIGGER_OUT_PIN, OUTPUT);
     pinMode(LASER_OUT_PIN, OUTPUT);
     initUSDistancePins(TRIGGER_OUT_PIN, ECHO_IN_PIN);
+#ifdef USE_FIXED_FRONT_US_SENSORS
+    addUSSensor(FRONT_RIGHT_TRIGGER_OUT_PIN, FRONT_RIGHT_ECHO_IN_PIN, FRONT_RIGHT_US_SENSOR_DEGREES);
+    addUSSensor(FRONT_TRIGGER_OUT_PIN, FRONT_ECHO_IN_PIN, FRONT_US_SENSOR_DEGREES);
+    addUSSensor(FRONT_LEFT_TRIGGER_OUT_PIN, FRONT_LEFT_ECHO_IN_PIN, FRONT_LEFT_US_SENSOR_DEGREES);
+    initFixedUSSensors();
+#endif
 
 #ifdef USE_TB6612_BREAKOUT_BOARD
     pinMode(CAMERA_SUPPLY_CONTROL_PIN, OUTPUT);
@@ -71,6 +85,18 @@ void setup() {
 // initialize motors
     RobotCar.init(TWO_WD_DETECTION_PIN);
 
+#ifdef USE_MPU6050_GYRO
+#  ifdef USE_TB6612_BREAKOUT_BOARD
+    // the motor shield library initializes Wire, the breakout board does not
+    Wire.begin();
+    Wire.setWireTimeout(MPU6050_I2C_TIMEOUT_MICROS, true);
+#  endif
+    if (initIMU()) {
+        // the car is still standing
+        learnIMUBias();
+    }
+#endif
+
 // reset all values
     resetPathData();
 
@@ -85,6 +111,9 @@ void setup() {
 
 void loop() {
     checkForLowVoltage();
+    // commits the motor values and learns the last stop also if the motors are not updated
+    updateMotorInfoStorage();
+    RobotCar.updateStopModels();
 
     // check if just timeout, no Bluetooth connection and connected to LIPO battery
     if ((!BlueDisplay1.isConnectionEstablished()) && (millis() < 11000) && (millis() > 10000)
@@ -132,18 +161,28 @@ void loop() {
         bool (*tfillForwardDistancesInfoFunction)(bool, bool);
         int (*tCollisionDetectionFunction)();
         tfillForwardDistancesInfoFunction = &fillForwardDistancesInfo;
-        if (sUseBuiltInAutonomousDriveStrategy) {
-            tCollisionDetectionFunction = &doBuiltInCollisionDetection;
-        } else {
-            tCollisionDetectionFunction = &doUserCollisionDetection;
-        }
         EncoderMotor::EnableValuesPrint = false;
 
         /*
          * Autonomous driving main loop
          */
         while (sRunAutonomousDrive) {
-            driveAutonomousOneStep(tfillForwardDistancesInfoFunction, tCollisionDetectionFunction);
+            // a navigation goal can be set while driving
+            if (sUseBuiltInAutonomousDriveStrategy && sNavigationIsActive) {
+                tCollisionDetectionFunction = &doNavigationCollisionDetection;
+            } else if (sUseBuiltInAutonomousDriveStrategy && sUseExploration) {
+                tCollisionDetectionFunction = &doExplorationCollisionDetection;
+            } else if (sUseBuiltInAutonomousDriveStrategy) {
+                tCollisionDetectionFunction = &doBuiltInCollisionDetection;
+            } else {
+                tCollisionDetectionFunction = &doUserCollisionDetection;
+            }
+            if (sUseBuiltInAutonomousDriveStrategy && sUseWallFollowing && !sNavigationIsActive) {
+                driveWallFollowingOneStep(tCollisionDetectionFunction);
+            } else {
+                stopWallFollowingSteering();
+                driveAutonomousOneStep(tfillForwardDistancesInfoFunction, tCollisionDetectionFunction);
+            }
             /*
              * check for user input and update display output
              */
@@ -159,6 +198,7 @@ void loop() {
         }
 
         EncoderMotor::EnableValuesPrint = true;
+        RobotCar.writeStopModelsToEeprom();
         US_ServoWriteAndDelay(90);
     }
 }
@@ -204,6 +244,34 @@ void readVINVoltage() {
     sVINVoltage = ((tVIN * (11.0 * 1.1)) / 1023) + 0.8;
 #else
     sVINVoltage = (tVIN * (11.0 * 1.1)) / 1023;
+#endif
+    EncoderMotor::SupplyDeciVolt = sVINVoltage * 10;
+    /*
+     * Temperature changes slowly, so update speed of sound only every US_TEMPERATURE_UPDATE_DIVIDER call
+     */
+    static uint8_t sTemperatureUpdateCounter = 0;
+    if (sTemperatureUpdateCounter == 0) {
+        sTemperatureUpdateCounter = US_TEMPERATURE_UPDATE_DIVIDER;
+        readTemperatureAndSetUSTemperature();
+    }
+    sTemperatureUpdateCounter--;
+}
+
+/*
+ * getTemperature() of BlueDisplay reads the internal sensor with the same 1.1 volt reference as readVINVoltage().
+ * It measures the chip temperature, which is some degree above the ambient temperature. This offset must be adjusted.
+ */
+void readTemperatureAndSetUSTemperature() {
+#if defined(US_TEMPERATURE_CELSIUS)
+    setUSTemperature(US_TEMPERATURE_CELSIUS);
+#elif defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__)
+    int tTemperature = getTemperature() - TEMPERATURE_SENSOR_OFFSET_CELSIUS;
+    if (tTemperature < -20) {
+        tTemperature = -20;
+    } else if (tTemperature > 60) {
+        tTemperature = 60;
+    }
+    setUSTemperature(tTemperature);
 #endif
 }
 
@@ -36,15 +36,15 @@
  * PIN  I/O Function
  *   2  I   Right encoder
  *   3  I   Left encoder
- *   4  O   Motor 0 fwd
- *   5  O   Motor 0 PWM
- *   6  O   Motor 1 PWM
- *   7  O   Motor 0 back
- *   8  O   Motor 1 fwd
+ *   4  O   Motor 0 fwd / US front right trigger for fixed front sensors
+ *   5  O   Motor 0 PWM / I US front right echo for fixed front sensors
+ *   6  O   Motor 1 PWM / US front trigger for fixed front sensors
+ *   7  O   Motor 0 back / I US front echo for fixed front sensors
+ *   8  O   Motor 1 fwd / US front left trigger for fixed front sensors
  *   9  O   Servo US
  *   10 O   Servo laser pan
  *   11 O   Servo tilt
- *   12 O   Motor 1 back
+ *   12 O   Motor 1 back / I US front left echo for fixed front sensors
  *   13 O   Laser power
  *
  *   A0 I   VCC/11 for UNO board / Camera supply control for breakout board version
@@ -64,6 +64,46 @@ const int TWO_WD_DETECTION_PIN = A3;
 const uint8_t TRIGGER_OUT_PIN = A1;
 const uint8_t ECHO_IN_PIN = A2;
 
+/*
+ * Three fixed US sensors at the front in addition to the one on the servo.
+ * They are measured round robin while the servo moves, so forward distances are measured at every servo step and not only once per sweep.
+ * The motor shield version uses I2C for the motors, so the motor pins of the breakout board version are free.
+ */
+//#define USE_FIXED_FRONT_US_SENSORS
+#ifdef USE_FIXED_FRONT_US_SENSORS
+#  ifdef USE_TB6612_BREAKOUT_BOARD
+#error "USE_FIXED_FRONT_US_SENSORS requires pins 4 to 8 and 12, which are used by the TB6612 breakout board"
+#  endif
+const uint8_t FRONT_RIGHT_TRIGGER_OUT_PIN = 4;
+const uint8_t FRONT_RIGHT_ECHO_IN_PIN = 5;
+#define FRONT_RIGHT_US_SENSOR_DEGREES 46 // index 2
+const uint8_t FRONT_TRIGGER_OUT_PIN = 6;
+const uint8_t FRONT_ECHO_IN_PIN = 7;
+#define FRONT_US_SENSOR_DEGREES 91 // index 4 and 5
+const uint8_t FRONT_LEFT_TRIGGER_OUT_PIN = 8;
+const uint8_t FRONT_LEFT_ECHO_IN_PIN = 12;
+#define FRONT_LEFT_US_SENSOR_DEGREES 136 // index 7
+#endif
+
+/*
+ * Turns of the autonomous drive are corrected until the real rotation measured by an additional sweep matches.
+ * Costs 1 to 3 additional sweeps per turn, but saves the rescans after bad turns.
+ */
+//#define USE_US_FAN_TURN_FEEDBACK
+
+/*
+ * Use the gyroscope of the phone for turns and path. The phone must lie screen up on the car, see PHONE_YAW_RATE.
+ */
+//#define USE_PHONE_HEADING_FUSION
+
+/*
+ * Use a MPU-6050 on the I2C bus instead of the phone for the heading fusion. Needs no Bluetooth bandwidth.
+ */
+//#define USE_MPU6050_GYRO
+#if defined(USE_PHONE_HEADING_FUSION) && defined(USE_MPU6050_GYRO)
+#error "Use only one of USE_PHONE_HEADING_FUSION and USE_MPU6050_GYRO"
+#endif
+
 // assume resistor network of 100k / 10k (divider by 11)
 #ifdef USE_TB6612_BREAKOUT_BOARD
 const uint8_t CAMERA_SUPPLY_CONTROL_PIN = A0;
@@ -72,6 +112,15 @@ const int VIN_11TH_IN_CHANNEL = 7; // = A7 on Nano board
 const int VIN_11TH_IN_CHANNEL = 0; // = A0
 #endif
 
+/*
+ * Temperature for the speed of sound used by the US distance sensor.
+ * Define a fixed value, if the internal temperature sensor of the ATmega328 should not be used.
+ */
+//#define US_TEMPERATURE_CELSIUS 20
+#define TEMPERATURE_SENSOR_OFFSET_CELSIUS 5 // chip temperature is higher than ambient temperature
+#define US_TEMPERATURE_UPDATE_DIVIDER 20 // update temperature every 20th VIN reading => every minute
+void readTemperatureAndSetUSTemperature();
+
 const int US_SERVO_PIN = 9;
 const int LASER_SERVO_PAN_PIN = 10;
 const int LASER_SERVO_TILT_PIN = 11;
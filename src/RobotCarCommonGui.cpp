@@ -21,6 +21,8 @@
 #include "RobotCarGui.h"
 #include "RobotCar.h"
 
+#include <MotorInfoStorage.h>
+
 uint8_t sActualPage;
 BDButton TouchButtonBackSmall;
 BDButton TouchButtonBack;
@@ -118,6 +120,7 @@ void startStopRobotCar(bool aNewStartedValue) {
     } else {
         // stop, but preserve direction
         RobotCar.shutdownMotors(false);
+        RobotCar.writeStopModelsToEeprom();
         if (sActualPage == PAGE_HOME|| sActualPage == PAGE_TEST) {
             SliderSpeed.setActualValueAndDrawBar(0);
         }
@@ -346,6 +349,10 @@ void printMotorValues() {
     tYPos += TEXT_SIZE_11;
     sprintf_P(sStringBuffer, PSTR("act. %3d %3d"), leftEncoderMotor.ActualSpeed, rightEncoderMotor.ActualSpeed);
     BlueDisplay1.drawText(BUTTON_WIDTH_6 + 4, tYPos, sStringBuffer, TEXT_SIZE_11, COLOR_BLACK, COLOR_WHITE);
+    tYPos += TEXT_SIZE_11;
+    // number of EEPROM commits of the values above
+    sprintf_P(sStringBuffer, PSTR("eeprom %5u"), sMotorInfoWriteCount);
+    BlueDisplay1.drawText(BUTTON_WIDTH_6 + 4, tYPos, sStringBuffer, TEXT_SIZE_11, COLOR_BLACK, COLOR_WHITE);
 
 }
 
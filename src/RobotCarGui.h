@@ -143,6 +143,7 @@ void delayAndLoopGUI(uint16_t aDelayMillis);
 void DrawPath();
 void resetPathData();
 void insertToPath(int aLength, int aDegree, bool aAddEntry);
+extern int sLastPathDirectionDegree;
 
 void clearPrintedForwardDistancesInfos();
 void drawForwardDistancesInfos();
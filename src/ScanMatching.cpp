@@ -0,0 +1,228 @@
+/*
+ * ScanMatching.cpp
+ *
+ * Contains:
+ * matchScanToReference(): Correlation of the actual sweep with the reference sweep, rotated by candidate angles.
+ * doScanMatchHeadingCorrection(): Corrects the heading after a turn and stores the actual sweep as new reference.
+ *
+ * The turns are done by odometry only, so every turn adds an error to the heading of path and exploration pose.
+ * After a turn, the reference sweep is linearly interpolated at sub index positions and compared with the new sweep
+ * for all rotations around the commanded one. The rotation with the smallest mean distance error is taken as the real one.
+ * The distances are compensated for the distance driven before and after the turn, like it is done by the distance history.
+ * All is done in integer arithmetic and the number of candidates is fixed, so the cost per sweep is bounded.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <Arduino.h>
+
+#include "ScanMatching.h"
+#include "AutonomousDrive.h"
+#include "DistanceFilter.h"
+#include "Exploration.h"
+#include "HeadingFusion.h"
+#include "RobotCar.h"
+
+// the interpolation does not fit, if the car has moved more than this between the two sweeps
+#define SCAN_MATCH_MAX_MOVE_CENTIMETER 40
+
+int8_t sScanMatchCorrectionDegrees;
+uint8_t sScanMatchMeanCentimeter;
+
+uint8_t sScanMatchReference[NUMBER_OF_DISTANCES];
+uint16_t sScanMatchReferenceMask; // indexes measured by the reference sweep. Bit 0 is INDEX_RIGHT
+int16_t sScanMatchReferenceEncoderPosition;
+int16_t sScanMatchTurnEncoderPosition;
+int sScanMatchCommandedDegrees; // sum of the turns since the reference sweep
+bool sScanMatchHasReference = false;
+
+void resetScanMatching() {
+    sScanMatchHasReference = false;
+    sScanMatchCommandedDegrees = 0;
+    sScanMatchCorrectionDegrees = 0;
+}
+
+/*
+ * To be called for each turn
+ */
+void addScanMatchRotation(int aRotationDegrees) {
+    if (aRotationDegrees == 0 || !sScanMatchHasReference) {
+        return;
+    }
+    if (sScanMatchCommandedDegrees == 0) {
+        sScanMatchTurnEncoderPosition = getEncoderPositionSum();
+    }
+    sScanMatchCommandedDegrees += aRotationDegrees;
+}
+
+static int16_t divideRounded(int16_t aDividend, int16_t aDivisor) {
+    if (aDividend >= 0) {
+        return (aDividend + (aDivisor / 2)) / aDivisor;
+    }
+    return -((-aDividend + (aDivisor / 2)) / aDivisor);
+}
+
+/*
+ * Distance as it would have been at the position of the turn. Returns -1 for values which cannot be matched.
+ * @param aMovedCentimeter positive if the car moved forward from the position of the measurement to the turn
+ */
+static int16_t getScanMatchDistance(uint8_t aDistance, uint8_t aIndex, int16_t aMovedCentimeter) {
+    if (aDistance >= US_TIMEOUT_CENTIMETER) {
+        return -1;
+    }
+    int16_t tDistance = aDistance - ((aMovedCentimeter * getSweepSinus256(aIndex)) / 256);
+    return max(tDistance, 0);
+}
+
+static int16_t getCommandedSubsteps() {
+    return divideRounded(sScanMatchCommandedDegrees * SCAN_MATCH_SUBSTEPS_PER_INDEX, SWEEP_DEGREES_PER_INDEX);
+}
+
+/*
+ * Indexes of the actual sweep, which can be paired with a measured index of the reference sweep
+ * for any rotation of the search window. Only these indexes must be measured for a match.
+ */
+uint16_t getScanMatchIndexMask() {
+    if (!sScanMatchHasReference) {
+        return 0;
+    }
+    int16_t tCommandedSubsteps = getCommandedSubsteps();
+    uint16_t tMask = 0;
+    for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+        int16_t tFirstPosition = (i * SCAN_MATCH_SUBSTEPS_PER_INDEX) + tCommandedSubsteps - SCAN_MATCH_WINDOW_SUBSTEPS;
+        int16_t tLastPosition = tFirstPosition + (2 * SCAN_MATCH_WINDOW_SUBSTEPS);
+        for (int8_t j = 0; j < NUMBER_OF_DISTANCES; ++j) {
+            int16_t tPosition = j * SCAN_MATCH_SUBSTEPS_PER_INDEX;
+            // reference index j is used for all positions from the previous index up to the next one
+            if ((sScanMatchReferenceMask & (1 << j)) && tPosition > tFirstPosition - SCAN_MATCH_SUBSTEPS_PER_INDEX
+                    && tPosition < tLastPosition + SCAN_MATCH_SUBSTEPS_PER_INDEX) {
+                tMask |= (1 << i);
+                break;
+            }
+        }
+    }
+    return tMask;
+}
+
+/*
+ * Rotation of the car between the reference sweep and the distances, searched around the commanded rotation.
+ * Returns false if there are too few pairs, the error is too big or the best rotation is at the border of the search window.
+ * @param aDistancesMask the indexes of aDistances which were measured after the turn
+ */
+bool matchScanToReference(uint8_t * aDistances, uint16_t aDistancesMask, int16_t * aRotationSubsteps) {
+    int16_t tReferenceMovedCentimeter = (sScanMatchTurnEncoderPosition - sScanMatchReferenceEncoderPosition)
+            / (2 * FACTOR_CENTIMETER_TO_COUNT);
+    int16_t tActualMovedCentimeter = (getEncoderPositionSum() - sScanMatchTurnEncoderPosition) / (2 * FACTOR_CENTIMETER_TO_COUNT);
+    if (abs(tReferenceMovedCentimeter) + abs(tActualMovedCentimeter) > SCAN_MATCH_MAX_MOVE_CENTIMETER) {
+        return false;
+    }
+
+    int16_t tReference[NUMBER_OF_DISTANCES];
+    int16_t tActual[NUMBER_OF_DISTANCES];
+    for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+        tReference[i] = -1;
+        if (sScanMatchReferenceMask & (1 << i)) {
+            tReference[i] = getScanMatchDistance(sScanMatchReference[i], i, tReferenceMovedCentimeter);
+        }
+        tActual[i] = -1;
+        if (aDistancesMask & (1 << i)) {
+            tActual[i] = getScanMatchDistance(aDistances[i], i, -tActualMovedCentimeter);
+        }
+    }
+
+    int16_t tCommandedSubsteps = getCommandedSubsteps();
+    int16_t tBestSubsteps = 0;
+    uint16_t tBestMean16 = 0xFFFF;
+    for (int16_t tSubsteps = tCommandedSubsteps - SCAN_MATCH_WINDOW_SUBSTEPS;
+            tSubsteps <= tCommandedSubsteps + SCAN_MATCH_WINDOW_SUBSTEPS; ++tSubsteps) {
+        uint16_t tErrorSum = 0;
+        uint8_t tPairs = 0;
+        for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+            if (tActual[i] < 0) {
+                continue;
+            }
+            // the value of actual index i was seen at this position by the reference sweep
+            int16_t tPosition = (i * SCAN_MATCH_SUBSTEPS_PER_INDEX) + tSubsteps;
+            if (tPosition < 0 || tPosition > (STEPS_PER_180_DEGREES * SCAN_MATCH_SUBSTEPS_PER_INDEX)) {
+                continue;
+            }
+            uint8_t tIndex = tPosition / SCAN_MATCH_SUBSTEPS_PER_INDEX;
+            uint8_t tFraction = tPosition % SCAN_MATCH_SUBSTEPS_PER_INDEX;
+            int16_t tReferenceDistance = tReference[tIndex];
+            if (tReferenceDistance < 0) {
+                continue;
+            }
+            if (tFraction != 0) {
+                if (tReference[tIndex + 1] < 0) {
+                    continue;
+                }
+                tReferenceDistance += ((tReference[tIndex + 1] - tReferenceDistance) * tFraction) / SCAN_MATCH_SUBSTEPS_PER_INDEX;
+            }
+            uint8_t tError = min(abs(tActual[i] - tReferenceDistance), SCAN_MATCH_MAX_PAIR_CENTIMETER);
+            tErrorSum += tError;
+            tPairs++;
+        }
+        if (tPairs < SCAN_MATCH_MIN_PAIRS) {
+            continue;
+        }
+        uint16_t tMean16 = (tErrorSum * 16) / tPairs;
+        // prefer the candidate nearest to the commanded rotation
+        if (tMean16 < tBestMean16
+                || (tMean16 == tBestMean16 && abs(tSubsteps - tCommandedSubsteps) < abs(tBestSubsteps - tCommandedSubsteps))) {
+            tBestMean16 = tMean16;
+            tBestSubsteps = tSubsteps;
+        }
+    }
+
+    if (tBestMean16 > SCAN_MATCH_MAX_MEAN_CENTIMETER * 16
+            || abs(tBestSubsteps - tCommandedSubsteps) == SCAN_MATCH_WINDOW_SUBSTEPS) {
+        return false;
+    }
+    sScanMatchMeanCentimeter = tBestMean16 / 16;
+    *aRotationSubsteps = tBestSubsteps;
+    return true;
+}
+
+/*
+ * Real rotation since the reference sweep, measured by aDistances. Used for closed loop turns too.
+ */
+bool getScanMatchRotationDegrees(uint8_t * aDistances, uint16_t aDistancesMask, int16_t * aRotationDegrees) {
+    int16_t tRotationSubsteps;
+    if (sScanMatchCommandedDegrees == 0 || !matchScanToReference(aDistances, aDistancesMask, &tRotationSubsteps)) {
+        return false;
+    }
+    *aRotationDegrees = divideRounded(tRotationSubsteps * SWEEP_DEGREES_PER_INDEX, SCAN_MATCH_SUBSTEPS_PER_INDEX);
+    return true;
+}
+
+/*
+ * To be called after each sweep.
+ * The correction is added to the last turn, which is used by insertToPath() for the actual ride, and to the exploration pose.
+ */
+void doScanMatchHeadingCorrection() {
+    uint16_t tMeasuredMask = 0;
+    for (uint8_t i = 0; i < NUMBER_OF_DISTANCES; ++i) {
+        if (sSweepAgeArray[i] == 0) {
+            tMeasuredMask |= (1 << i);
+        }
+    }
+    if (sScanMatchCommandedDegrees != 0) {
+        int16_t tRotationDegrees;
+        // the fused heading is better than a scan match
+        if (!isHeadingFusionValid()
+                && getScanMatchRotationDegrees(sForwardDistancesInfo.RawDistancesArray, tMeasuredMask, &tRotationDegrees)) {
+            sScanMatchCorrectionDegrees = tRotationDegrees - sScanMatchCommandedDegrees;
+            sLastDegreesTurned += sScanMatchCorrectionDegrees;
+            rotateExplorationPose(sScanMatchCorrectionDegrees);
+        }
+        sScanMatchCommandedDegrees = 0;
+    }
+
+    /*
+     * The actual sweep is the reference for the next turn
+     */
+    memcpy(sScanMatchReference, sForwardDistancesInfo.RawDistancesArray, NUMBER_OF_DISTANCES);
+    sScanMatchReferenceMask = tMeasuredMask;
+    sScanMatchReferenceEncoderPosition = getEncoderPositionSum();
+    sScanMatchHasReference = true;
+}
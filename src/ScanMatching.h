@@ -0,0 +1,35 @@
+/*
+ * ScanMatching.h
+ *
+ *  Estimates the real rotation of a turn by matching the sweep after the turn with the sweep before it.
+ *  The difference to the commanded rotation corrects the heading of path and exploration pose.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SRC_SCANMATCHING_H_
+#define SRC_SCANMATCHING_H_
+
+#include <stdint.h>
+
+// rotations are computed in 1/16 of a sweep index i.e. in 1.125 degree
+#define SCAN_MATCH_SUBSTEPS_PER_INDEX 16
+// the real rotation is searched +/- this number of substeps around the commanded one => 23 candidates with 10 pairs each
+#define SCAN_MATCH_WINDOW_SUBSTEPS 11
+// a pair contributes at most this value to the error, to reduce the influence of objects seen only in one sweep
+#define SCAN_MATCH_MAX_PAIR_CENTIMETER 30
+#define SCAN_MATCH_MIN_PAIRS 4
+// the match is rejected, if the mean error of the best candidate is greater
+#define SCAN_MATCH_MAX_MEAN_CENTIMETER 8
+
+extern int8_t sScanMatchCorrectionDegrees; // of the last successful match, positive if car turned more left than commanded
+extern uint8_t sScanMatchMeanCentimeter; // mean error of the last match
+
+void resetScanMatching();
+void addScanMatchRotation(int aRotationDegrees);
+uint16_t getScanMatchIndexMask();
+bool matchScanToReference(uint8_t * aDistances, uint16_t aDistancesMask, int16_t * aRotationSubsteps);
+bool getScanMatchRotationDegrees(uint8_t * aDistances, uint16_t aDistancesMask, int16_t * aRotationDegrees);
+void doScanMatchHeadingCorrection();
+
+#endif /* SRC_SCANMATCHING_H_ */
@@ -0,0 +1,88 @@
+/*
+ * SpeedGovernor.cpp
+ *
+ * The car must be able to stop before the nearest obstacle in the forward cone, even if the obstacle is detected
+ * only at the end of the next sweep. So it may drive the free distance in the time of one sweep plus its braking time.
+ * The speed for this velocity is computed with the velocity per speed unit, which is learned while driving at full speed.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <EncoderMotor.h>
+
+#include "SpeedGovernor.h"
+#include "AutonomousDrive.h"
+#include "RobotCar.h"
+#include "TimeToCollision.h"
+
+uint16_t sSweepMillis;
+uint16_t sVelocityPerSpeed;
+uint8_t sGovernorSpeed;
+
+/*
+ * Call it if car is at full speed. ActualVelocity is in cm/s.
+ */
+void learnVelocityPerSpeed() {
+    if (rightEncoderMotor.State == MOTOR_STATE_FULL_SPEED && rightEncoderMotor.ActualSpeed > 0
+            && rightEncoderMotor.ActualVelocity > 0 && rightEncoderMotor.ActualVelocity < 99) {
+        uint16_t tVelocityPerSpeed = ((uint16_t) rightEncoderMotor.ActualVelocity << 8) / rightEncoderMotor.ActualSpeed;
+        if (sVelocityPerSpeed == 0) {
+            sVelocityPerSpeed = tVelocityPerSpeed;
+        } else {
+            // low pass
+            sVelocityPerSpeed = (sVelocityPerSpeed * 3 + tVelocityPerSpeed) / 4;
+        }
+    }
+}
+
+/*
+ * Returns speed between MinSpeed and MaxSpeed. Uses the actual ProcessedDistancesArray and sSweepMillis.
+ */
+uint8_t computeGovernorSpeed() {
+    uint8_t tFreeCentimeter = US_TIMEOUT_CENTIMETER;
+    for (uint8_t i = GOVERNOR_FIRST_INDEX; i <= GOVERNOR_LAST_INDEX; ++i) {
+        if (sForwardDistancesInfo.ProcessedDistancesArray[i] < tFreeCentimeter) {
+            tFreeCentimeter = sForwardDistancesInfo.ProcessedDistancesArray[i];
+        }
+    }
+    return computeGovernorSpeed(tFreeCentimeter, sSweepMillis);
+}
+
+/*
+ * aMeasurementPeriodMillis is the time until the free distance is measured again
+ */
+uint8_t computeGovernorSpeed(uint8_t aFreeCentimeter, uint16_t aMeasurementPeriodMillis) {
+    uint8_t tMinSpeed = rightEncoderMotor.MinSpeed;
+    uint8_t tMaxSpeed = rightEncoderMotor.MaxSpeed;
+
+    uint8_t tFreeCentimeter = aFreeCentimeter;
+    if (tFreeCentimeter <= GOVERNOR_SAFETY_CENTIMETER) {
+        sGovernorSpeed = tMinSpeed;
+        return sGovernorSpeed;
+    }
+    tFreeCentimeter -= GOVERNOR_SAFETY_CENTIMETER;
+
+    if (sVelocityPerSpeed == 0) {
+        // nothing learned yet
+        sGovernorSpeed = tMinSpeed + (tMaxSpeed - tMinSpeed) / 2;
+        return sGovernorSpeed;
+    }
+
+    /*
+     * Braking distance is assumed to be proportional to velocity, so braking time is constant
+     */
+    uint16_t tBrakingMillis = GOVERNOR_DEFAULT_BRAKING_MILLIS;
+    if (!RobotCar.isStopped() && rightEncoderMotor.ActualVelocity > 0 && rightEncoderMotor.ActualVelocity < 99) {
+        tBrakingMillis = (getBrakingCentimeter() * 1000L) / rightEncoderMotor.ActualVelocity;
+    }
+
+    uint16_t tVelocity = ((uint32_t) tFreeCentimeter * 1000) / (aMeasurementPeriodMillis + tBrakingMillis);
+    uint16_t tSpeed = ((uint32_t) tVelocity << 8) / sVelocityPerSpeed;
+    if (tSpeed < tMinSpeed) {
+        tSpeed = tMinSpeed;
+    } else if (tSpeed > tMaxSpeed) {
+        tSpeed = tMaxSpeed;
+    }
+    sGovernorSpeed = tSpeed;
+    return sGovernorSpeed;
+}
@@ -0,0 +1,30 @@
+/*
+ * SpeedGovernor.h
+ *
+ *  Target speed for autonomous cruising from the free space ahead, the braking distance and the sweep period.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SRC_SPEEDGOVERNOR_H_
+#define SRC_SPEEDGOVERNOR_H_
+
+#include <stdint.h>
+
+// distance which is kept to the nearest obstacle in the forward cone
+#define GOVERNOR_SAFETY_CENTIMETER 10
+// used as long as braking time is not known
+#define GOVERNOR_DEFAULT_BRAKING_MILLIS 250
+// forward cone of ProcessedDistancesArray
+#define GOVERNOR_FIRST_INDEX (INDEX_FORWARD_1 - 1)
+#define GOVERNOR_LAST_INDEX (INDEX_FORWARD_2 + 1)
+
+extern uint16_t sSweepMillis; // duration of last sweep
+extern uint16_t sVelocityPerSpeed; // cm/s per speed unit * 256, learned at full speed
+extern uint8_t sGovernorSpeed; // last computed speed
+
+void learnVelocityPerSpeed();
+uint8_t computeGovernorSpeed();
+uint8_t computeGovernorSpeed(uint8_t aFreeCentimeter, uint16_t aMeasurementPeriodMillis);
+
+#endif /* SRC_SPEEDGOVERNOR_H_ */
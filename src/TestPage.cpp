@@ -54,6 +54,9 @@ BDButton TouchButton90DegreeRight;
 BDButton TouchButton90DegreeLeft;
 BDButton TouchButton360Degree;
 
+BDButton TouchButtonCalibrateServo;
+BDButton TouchButtonCalibrateTurn;
+
 bool sShowDebug = false;
 
 /*
@@ -109,6 +112,32 @@ void doUSServoPosition(BDSlider * aTheTouchedSlider, uint16_t aValue) {
     US_ServoWriteAndDelay(aValue);
 }
 
+/*
+ * Place a narrow target in front of the car before
+ */
+void doCalibrateServo(BDButton * aTheTouchedButton, int16_t aValue) {
+    if (calibrateUSServo()) {
+        sprintf_P(sStringBuffer, PSTR("Servo %uus/\xB0 %ums"), USDistanceServo.microsPerDegree, USDistanceServo.settleMillis);
+    } else {
+        strcpy_P(sStringBuffer, PSTR("Servo calibration failed"));
+    }
+    BlueDisplay1.debugMessage(sStringBuffer);
+}
+
+/*
+ * Place the car in front of a flat wall before
+ */
+void doCalibrateTurn(BDButton * aTheTouchedButton, int16_t aValue) {
+    if (calibrateTurnFactors()) {
+        sprintf_P(sStringBuffer, PSTR("Turn %u %u %u %u"), RobotCar.TurnFactors[TURN_FACTOR_LEFT_SLOW],
+                RobotCar.TurnFactors[TURN_FACTOR_RIGHT_SLOW], RobotCar.TurnFactors[TURN_FACTOR_LEFT],
+                RobotCar.TurnFactors[TURN_FACTOR_RIGHT]);
+    } else {
+        strcpy_P(sStringBuffer, PSTR("Turn calibration failed"));
+    }
+    BlueDisplay1.debugMessage(sStringBuffer);
+}
+
 void doReset(BDButton * aTheTouchedButton, int16_t aValue) {
     RobotCar.resetAndShutdownMotors();
     setDirectionButtonCaption();
@@ -166,6 +195,11 @@ void initTestPage(void) {
     TouchButton360Degree.init(BUTTON_WIDTH_8_POS_6, BUTTON_HEIGHT_8_LINE_4, BUTTON_WIDTH_8, BUTTON_HEIGHT_8, COLOR_BLUE,
             F("360\xB0"), TEXT_SIZE_11, FLAG_BUTTON_DO_BEEP_ON_TOUCH, 360, &doRotation);
 
+    TouchButtonCalibrateServo.init(BUTTON_WIDTH_8_POS_6, BUTTON_HEIGHT_8_LINE_6, BUTTON_WIDTH_8, BUTTON_HEIGHT_8, COLOR_BLUE,
+            F("Srv"), TEXT_SIZE_11, FLAG_BUTTON_DO_BEEP_ON_TOUCH, 0, &doCalibrateServo);
+    TouchButtonCalibrateTurn.init(BUTTON_WIDTH_8_POS_5, BUTTON_HEIGHT_8_LINE_6, BUTTON_WIDTH_8, BUTTON_HEIGHT_8, COLOR_BLUE,
+            F("Trn"), TEXT_SIZE_11, FLAG_BUTTON_DO_BEEP_ON_TOUCH, 0, &doCalibrateTurn);
+
     TouchButtonDebug.init(BUTTON_WIDTH_8_POS_6, BUTTON_HEIGHT_8_LINE_3, BUTTON_WIDTH_8, BUTTON_HEIGHT_8, COLOR_RED, F("dbg"),
     TEXT_SIZE_11, FLAG_BUTTON_DO_BEEP_ON_TOUCH | FLAG_BUTTON_TYPE_TOGGLE_RED_GREEN, sShowDebug, &doShowDebug);
 }
@@ -192,6 +226,8 @@ void drawTestPage(void) {
     TouchButton90DegreeLeft.drawButton();
     TouchButton90DegreeRight.drawButton();
     TouchButton360Degree.drawButton();
+    TouchButtonCalibrateServo.drawButton();
+    TouchButtonCalibrateTurn.drawButton();
 
     SliderSpeed.drawSlider();
     SliderSpeedRight.drawSlider();
@@ -283,5 +319,18 @@ void printMotorDebugValues() {
     sprintf_P(sStringBuffer, PSTR("tcnt %3d %3d"), leftEncoderMotor.LastTargetDistanceCount,
             rightEncoderMotor.LastTargetDistanceCount);
     BlueDisplay1.drawText(BUTTON_WIDTH_6 + 4, tYPos, sStringBuffer, TEXT_SIZE_11, COLOR_BLACK, COLOR_WHITE);
+
+#ifndef USE_TB6612_BREAKOUT_BOARD
+    // I2C timeouts and bus recoveries
+    tYPos += TEXT_SIZE_11;
+    sprintf_P(sStringBuffer, PSTR("i2c  %3u %3u"), Wire.getWireTimeoutCount(), Wire.getWireRecoveryCount());
+    BlueDisplay1.drawText(BUTTON_WIDTH_6 + 4, tYPos, sStringBuffer, TEXT_SIZE_11, COLOR_BLACK, COLOR_WHITE);
+#endif
+#ifdef MEASURE_SERVO_ISR_DURATION
+    // longest servo ISR in microseconds
+    tYPos += TEXT_SIZE_11;
+    sprintf_P(sStringBuffer, PSTR("srv  %3u"), Servo::getMaxISRMicros());
+    BlueDisplay1.drawText(BUTTON_WIDTH_6 + 4, tYPos, sStringBuffer, TEXT_SIZE_11, COLOR_BLACK, COLOR_WHITE);
+#endif
 }
 
@@ -0,0 +1,158 @@
+/*
+ * TimeToCollision.cpp
+ *
+ * Contains:
+ * computeTimeToCollisionMillis(): Time until the car reaches the obstacle minus its braking distance.
+ * getCollisionResponse(): Graded response for a time to collision.
+ * checkForwardDistance(): Computes and executes the response for a new forward distance.
+ *     Going back is only requested, since it is called during the sweep. driveAutonomousOneStep() does it after the sweep.
+ *
+ * The closing velocity is the wheel velocity or the decrease of consecutive forward distances, whichever is greater.
+ * The braking distance is the ramp down distance, which EncoderMotor takes for stopCar().
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <EncoderMotor.h>
+
+#include "TimeToCollision.h"
+#include "DistanceFilter.h"
+#include "RobotCar.h"
+#include "RobotCarGui.h"
+
+uint16_t sTimeToCollisionMillis = TTC_INFINITE;
+uint8_t sClosingVelocity;
+uint8_t sLastCollisionResponse = TTC_RESPONSE_NONE;
+bool sCollisionReverseIsRequested = false;
+
+unsigned int sLastForwardCentimeter;
+unsigned long sLastForwardMillis;
+uint8_t sWheelVelocity; // low pass of the valid wheel velocities
+
+void resetTimeToCollision() {
+    sTimeToCollisionMillis = TTC_INFINITE;
+    sClosingVelocity = 0;
+    sLastCollisionResponse = TTC_RESPONSE_NONE;
+    sCollisionReverseIsRequested = false;
+    sLastForwardMillis = 0;
+    sWheelVelocity = 0;
+}
+
+/*
+ * Wheel velocity in cm/s. Ringing values are skipped and the others are averaged with the last result.
+ * ActualVelocity is written by the encoder ISR, so it is read with interrupts disabled.
+ */
+uint8_t getFilteredWheelVelocity() {
+    if (RobotCar.isStopped() || !RobotCar.isDirectionForward) {
+        sWheelVelocity = 0;
+        return 0;
+    }
+    noInterrupts();
+    int16_t tVelocity = rightEncoderMotor.ActualVelocity;
+    interrupts();
+    if (tVelocity > 0 && tVelocity < TTC_RINGING_VELOCITY) {
+        if (sWheelVelocity == 0) {
+            sWheelVelocity = tVelocity;
+        } else {
+            sWheelVelocity = (sWheelVelocity + tVelocity + 1) / 2;
+        }
+    }
+    return sWheelVelocity;
+}
+
+/*
+ * stopCar() uses DistanceCountAfterRampUp as ramp down count
+ */
+uint8_t getBrakingCentimeter() {
+    uint8_t tRampDownCount = rightEncoderMotor.DistanceCountAfterRampUp;
+    if (tRampDownCount < RAMP_DOWN_MIN_TICKS) {
+        tRampDownCount = RAMP_DOWN_MIN_TICKS;
+    }
+    return (tRampDownCount + (FACTOR_CENTIMETER_TO_COUNT - 1)) / FACTOR_CENTIMETER_TO_COUNT;
+}
+
+/*
+ * Updates sClosingVelocity and sTimeToCollisionMillis
+ * Returns TTC_INFINITE if car is stopped and obstacle does not approach.
+ */
+uint16_t computeTimeToCollisionMillis(unsigned int aForwardCentimeter) {
+    unsigned long tMillis = millis();
+
+    uint8_t tWheelVelocity = getFilteredWheelVelocity();
+    uint8_t tDistanceVelocity = 0;
+    if (sLastForwardMillis != 0 && tMillis - sLastForwardMillis < TTC_MAX_SAMPLE_AGE_MILLIS
+            && aForwardCentimeter < sLastForwardCentimeter && sLastForwardCentimeter < US_TIMEOUT_CENTIMETER) {
+        unsigned int tDistanceVelocityLong = ((sLastForwardCentimeter - aForwardCentimeter) * 1000L)
+                / (tMillis - sLastForwardMillis + 1);
+        // clip measurement noise
+        if (tDistanceVelocityLong > tWheelVelocity + TTC_MAX_OBSTACLE_VELOCITY) {
+            tDistanceVelocityLong = tWheelVelocity + TTC_MAX_OBSTACLE_VELOCITY;
+        }
+        tDistanceVelocity = tDistanceVelocityLong;
+    }
+    sLastForwardCentimeter = aForwardCentimeter;
+    sLastForwardMillis = tMillis;
+
+    sClosingVelocity = max(tWheelVelocity, tDistanceVelocity);
+    if (sClosingVelocity == 0) {
+        sTimeToCollisionMillis = TTC_INFINITE;
+    } else {
+        // we know nothing beyond the US timeout
+        if (aForwardCentimeter > US_TIMEOUT_CENTIMETER) {
+            aForwardCentimeter = US_TIMEOUT_CENTIMETER;
+        }
+        uint8_t tBrakingCentimeter = getBrakingCentimeter();
+        if (aForwardCentimeter <= tBrakingCentimeter) {
+            sTimeToCollisionMillis = 0;
+        } else {
+            unsigned long tTTC = ((aForwardCentimeter - tBrakingCentimeter) * 1000L) / sClosingVelocity;
+            if (tTTC >= TTC_INFINITE) {
+                tTTC = TTC_INFINITE - 1;
+            }
+            sTimeToCollisionMillis = tTTC;
+        }
+    }
+    return sTimeToCollisionMillis;
+}
+
+/*
+ * Uses sTimeToCollisionMillis of last computeTimeToCollisionMillis()
+ */
+uint8_t getCollisionResponse(unsigned int aForwardCentimeter) {
+    if (RobotCar.isStopped() || sTimeToCollisionMillis == TTC_INFINITE) {
+        return TTC_RESPONSE_NONE;
+    }
+    if (aForwardCentimeter < TTC_REVERSE_CENTIMETER) {
+        return TTC_RESPONSE_REVERSE;
+    }
+    if (sTimeToCollisionMillis < TTC_STOP_MILLIS) {
+        return TTC_RESPONSE_STOP;
+    }
+    if (sTimeToCollisionMillis < TTC_SLOW_DOWN_MILLIS) {
+        return TTC_RESPONSE_SLOW_DOWN;
+    }
+    return TTC_RESPONSE_NONE;
+}
+
+void doCollisionResponse(uint8_t aResponse) {
+    if (aResponse == TTC_RESPONSE_SLOW_DOWN) {
+        // half way between MinSpeed and actual speed
+        RobotCar.changeMaxSpeed(
+                rightEncoderMotor.MinSpeed + ((int) rightEncoderMotor.ActualSpeed - (int) rightEncoderMotor.MinSpeed) / 2);
+    } else if (aResponse == TTC_RESPONSE_STOP) {
+        RobotCar.stopCar();
+    } else if (aResponse == TTC_RESPONSE_REVERSE) {
+        RobotCar.stopCar();
+        sCollisionReverseIsRequested = true;
+    }
+}
+
+/*
+ * To be called for each new forward distance
+ */
+uint8_t checkForwardDistance(unsigned int aForwardCentimeter) {
+    computeTimeToCollisionMillis(aForwardCentimeter);
+    sLastCollisionResponse = getCollisionResponse(aForwardCentimeter);
+    doCollisionResponse(sLastCollisionResponse);
+    return sLastCollisionResponse;
+}
@@ -0,0 +1,46 @@
+/*
+ * TimeToCollision.h
+ *
+ *  Estimation of the time to collision from consecutive forward distances and wheel velocity
+ *  and graded responses (slow down, stop, reverse).
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SRC_TIMETOCOLLISION_H_
+#define SRC_TIMETOCOLLISION_H_
+
+#include <stdint.h>
+
+#define TTC_RESPONSE_NONE 0
+#define TTC_RESPONSE_SLOW_DOWN 1
+#define TTC_RESPONSE_STOP 2
+#define TTC_RESPONSE_REVERSE 3
+
+#define TTC_SLOW_DOWN_MILLIS 1500
+#define TTC_STOP_MILLIS 500
+// below this distance the car goes back if it is moving
+#define TTC_REVERSE_CENTIMETER 10
+#define TTC_REVERSE_DISTANCE_CENTIMETER 10
+// older forward distances are not used for computing the closing velocity
+#define TTC_MAX_SAMPLE_AGE_MILLIS 1000
+// obstacles are assumed to not move faster than this towards the car
+#define TTC_MAX_OBSTACLE_VELOCITY 50
+// EncoderMotor sets ActualVelocity to this value if the encoder signal rings, e.g. near standstill
+#define TTC_RINGING_VELOCITY 99
+
+#define TTC_INFINITE 0xFFFF
+
+extern uint16_t sTimeToCollisionMillis; // of last forward distance
+extern uint8_t sClosingVelocity; // cm/s
+extern uint8_t sLastCollisionResponse;
+extern bool sCollisionReverseIsRequested; // set by TTC_RESPONSE_REVERSE, the car goes back at step level
+
+uint8_t getBrakingCentimeter();
+uint16_t computeTimeToCollisionMillis(unsigned int aForwardCentimeter);
+uint8_t getCollisionResponse(unsigned int aForwardCentimeter);
+void doCollisionResponse(uint8_t aResponse);
+uint8_t checkForwardDistance(unsigned int aForwardCentimeter);
+void resetTimeToCollision();
+
+#endif /* SRC_TIMETOCOLLISION_H_ */
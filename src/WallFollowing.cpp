@@ -0,0 +1,250 @@
+/*
+ * WallFollowing.cpp
+ *
+ * The wall is the line through the points of the side and the oblique US distance.
+ * Its angle and its perpendicular distance give the speed difference of the motors, which is set once per cycle.
+ * One cycle measures side, oblique and forward distance. The servo runs back and forth between side and front,
+ * so it never moves more than 80 degree per cycle.
+ *
+ * Without a wall, at the end of the wall or if the forward distance is too short, one step of the built in
+ * autonomous drive with a full sweep and the given collision detection is done, which also selects the next wall to follow.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <Arduino.h>
+#include <EncoderMotor.h>
+
+#include "WallFollowing.h"
+#include "AutonomousDrive.h"
+#include "RobotCar.h"
+#include "RobotCarGui.h"
+#include "TimeToCollision.h"
+#include "SpeedGovernor.h"
+#include "DistanceFilter.h"
+#include "HeadingFusion.h"
+#include "Exploration.h"
+
+bool sUseWallFollowing = false;
+uint8_t sWallFollowingSide = WALL_FOLLOWING_SIDE_NONE;
+uint8_t sWallFollowingTargetCentimeter = WALL_FOLLOWING_TARGET_CENTIMETER;
+int8_t sWallFollowingAngleDegrees;
+uint8_t sWallFollowingDistanceCentimeter;
+int8_t sWallFollowingSpeedDifference;
+uint16_t sWallFollowingCycleMillis;
+int16_t sWallFollowingSegmentHeadingDegrees; // heading at the start of the actual path segment
+
+void resetWallFollowing() {
+    sWallFollowingSide = WALL_FOLLOWING_SIDE_NONE;
+    sWallFollowingTargetCentimeter = WALL_FOLLOWING_TARGET_CENTIMETER;
+    sWallFollowingSpeedDifference = 0;
+}
+
+/*
+ * Selects the nearer wall of the last sweep. In a corridor narrower than 2 times the target distance, the center is held.
+ * Returns false if no wall is near.
+ */
+bool selectWallFollowingSide() {
+    uint8_t tRightCentimeter = sForwardDistancesInfo.ProcessedDistancesArray[INDEX_RIGHT];
+    uint8_t tLeftCentimeter = sForwardDistancesInfo.ProcessedDistancesArray[INDEX_LEFT];
+    sWallFollowingTargetCentimeter = WALL_FOLLOWING_TARGET_CENTIMETER;
+    if (tRightCentimeter <= WALL_FOLLOWING_MAX_WALL_CENTIMETER && tLeftCentimeter <= WALL_FOLLOWING_MAX_WALL_CENTIMETER
+            && (tRightCentimeter + tLeftCentimeter) / 2 < WALL_FOLLOWING_TARGET_CENTIMETER) {
+        sWallFollowingTargetCentimeter = (tRightCentimeter + tLeftCentimeter) / 2;
+    }
+
+    if (tRightCentimeter <= tLeftCentimeter && tRightCentimeter <= WALL_FOLLOWING_MAX_WALL_CENTIMETER) {
+        sWallFollowingSide = WALL_FOLLOWING_SIDE_RIGHT;
+    } else if (tLeftCentimeter <= WALL_FOLLOWING_MAX_WALL_CENTIMETER) {
+        sWallFollowingSide = WALL_FOLLOWING_SIDE_LEFT;
+    } else {
+        sWallFollowingSide = WALL_FOLLOWING_SIDE_NONE;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Computes angle and distance of the wall for the right side. The left side is the mirror image.
+ * x is forward and y is towards the wall. Returns false if the points do not form a wall.
+ */
+bool computeWallFollowingWall(unsigned int aSideCentimeter, unsigned int aObliqueCentimeter) {
+    if (aSideCentimeter == 0 || aSideCentimeter >= US_TIMEOUT_CENTIMETER || aObliqueCentimeter == 0
+            || aObliqueCentimeter >= US_TIMEOUT_CENTIMETER) {
+        return false;
+    }
+    float tSideRadian = (90 - WALL_FOLLOWING_SIDE_DEGREES) * DEG_TO_RAD;
+    float tObliqueRadian = (90 - WALL_FOLLOWING_OBLIQUE_DEGREES) * DEG_TO_RAD;
+    float tSideX = aSideCentimeter * cos(tSideRadian);
+    float tSideY = aSideCentimeter * sin(tSideRadian);
+    float tWallX = (aObliqueCentimeter * cos(tObliqueRadian)) - tSideX;
+    float tWallY = (aObliqueCentimeter * sin(tObliqueRadian)) - tSideY;
+    if (tWallX <= 0) {
+        return false;
+    }
+
+    int tAngleDegrees = atan2(-tWallY, tWallX) * RAD_TO_DEG;
+    // perpendicular distance of the car to the line
+    int tDistance = fabs((tSideX * tWallY) - (tSideY * tWallX)) / sqrt((tWallX * tWallX) + (tWallY * tWallY));
+    if (abs(tAngleDegrees) > WALL_FOLLOWING_MAX_WALL_DEGREES || tDistance > WALL_FOLLOWING_MAX_WALL_CENTIMETER) {
+        return false;
+    }
+    sWallFollowingAngleDegrees = tAngleDegrees;
+    sWallFollowingDistanceCentimeter = tDistance;
+    return true;
+}
+
+/*
+ * Steer away if approaching the wall or too near, steer towards it if too far
+ */
+int8_t computeWallFollowingSpeedDifference() {
+    int tDistanceError = (int) sWallFollowingDistanceCentimeter - (int) sWallFollowingTargetCentimeter;
+    int tSpeedDifference = ((sWallFollowingAngleDegrees * WALL_FOLLOWING_ANGLE_GAIN_16)
+            - (tDistanceError * WALL_FOLLOWING_DISTANCE_GAIN_16)) / 16;
+    tSpeedDifference = constrain(tSpeedDifference, -WALL_FOLLOWING_MAX_SPEED_DIFFERENCE, WALL_FOLLOWING_MAX_SPEED_DIFFERENCE);
+    if (sWallFollowingSide == WALL_FOLLOWING_SIDE_LEFT) {
+        tSpeedDifference = -tSpeedDifference;
+    }
+    return tSpeedDifference;
+}
+
+void startWallFollowingPath() {
+    sWallFollowingSegmentHeadingDegrees = getFusedHeadingDegrees();
+}
+
+/*
+ * The heading changed by the steering is taken from the heading fusion, which integrates the encoder yaw without gyroscope.
+ * If it has changed by WALL_FOLLOWING_PATH_SEGMENT_DEGREES or at the end of the curve, the actual path segment is closed
+ * and the change is added to the exploration pose and to sLastDegreesTurned for the next segment.
+ * The distance counts are then restarted, so the ride after the curve contains only the last segment.
+ */
+void updateWallFollowingPath(bool aIsEndOfCurve) {
+    int tCurveDegrees = ((getFusedHeadingDegrees() - sWallFollowingSegmentHeadingDegrees + 540) % 360) - 180;
+    if (abs(tCurveDegrees) < WALL_FOLLOWING_PATH_SEGMENT_DEGREES && (!aIsEndOfCurve || tCurveDegrees == 0)) {
+        // overwrite last path element with actual riding distance
+        insertToPath(rightEncoderMotor.DistanceCount, sLastDegreesTurned, false);
+        return;
+    }
+    noInterrupts();
+    uint16_t tSegmentCount = rightEncoderMotor.DistanceCount;
+    rightEncoderMotor.DistanceCount = 0;
+    leftEncoderMotor.DistanceCount = 0;
+    rightEncoderMotor.LastRideDistanceCount = 0;
+    leftEncoderMotor.LastRideDistanceCount = 0;
+    interrupts();
+    insertToPath(tSegmentCount, sLastDegreesTurned, true);
+    // integrates the distance of the segment with the old heading
+    rotateExplorationPose(tCurveDegrees);
+    sLastDegreesTurned = tCurveDegrees;
+    sWallFollowingSegmentHeadingDegrees = (sWallFollowingSegmentHeadingDegrees + tCurveDegrees + 360) % 360;
+}
+
+/*
+ * Back to straight driving. Must be called before the next full sweep.
+ */
+void stopWallFollowingSteering() {
+    if (sWallFollowingSide == WALL_FOLLOWING_SIDE_NONE) {
+        return;
+    }
+    updateWallFollowingPath(true);
+    sWallFollowingSide = WALL_FOLLOWING_SIDE_NONE;
+    sWallFollowingSpeedDifference = 0;
+    if (!RobotCar.isStopped()) {
+        RobotCar.changeMaxSpeed(sGovernorSpeed);
+    }
+    // the counts differ by the curves driven, which must not be taken for different motors by synchronizeMotor()
+    noInterrupts();
+    leftEncoderMotor.DistanceCount = rightEncoderMotor.DistanceCount;
+    interrupts();
+    // the distance history is not compensated for the curves
+    resetDistanceHistory();
+}
+
+/*
+ * Does not call US_ServoWriteAndDelay() with delay, since it synchronizes the motors
+ */
+unsigned int getWallFollowingDistance(uint8_t aServoDegrees) {
+    US_ServoWriteAndDelay(aServoDegrees);
+    loopGUI();
+    updateHeadingFusion();
+    delay(USDistanceServo.getMillisUntilSettled());
+    return getUSDistanceAsCentiMeterWithHorizon(US_TIMEOUT_CENTIMETER, US_TIMEOUT_CENTIMETER);
+}
+
+void drawWallFollowingInfo() {
+    char tStringBuffer[20];
+    sprintf_P(tStringBuffer, PSTR("%c%3dcm%4d\xB0%4d"), (sWallFollowingSide == WALL_FOLLOWING_SIDE_LEFT ? 'L' : 'R'),
+            sWallFollowingDistanceCentimeter, sWallFollowingAngleDegrees, sWallFollowingSpeedDifference);
+    BlueDisplay1.drawText(0, BUTTON_HEIGHT_4_LINE_4 - TEXT_SIZE_11_DECEND - (2 * TEXT_SIZE_11), tStringBuffer, TEXT_SIZE_11,
+            COLOR_BLACK, COLOR_WHITE);
+}
+
+/*
+ * One cycle of wall following or one step of the built in autonomous drive, if no wall is followed.
+ * Wall following is only done in continuous mode.
+ */
+void driveWallFollowingOneStep(int (*aCollisionDetectionFunction)()) {
+    if (sWallFollowingSide == WALL_FOLLOWING_SIDE_NONE || sStepMode != MODE_CONTINUOUS || RobotCar.isStopped()) {
+        stopWallFollowingSteering();
+        driveAutonomousOneStep(&fillForwardDistancesInfo, aCollisionDetectionFunction);
+        if (sStepMode == MODE_CONTINUOUS && sNextDegreesToTurn == 0 && !RobotCar.isStopped() && selectWallFollowingSide()) {
+            startWallFollowingPath();
+        }
+        return;
+    }
+
+    uint8_t tSideDegrees = WALL_FOLLOWING_SIDE_DEGREES;
+    uint8_t tObliqueDegrees = WALL_FOLLOWING_OBLIQUE_DEGREES;
+    if (sWallFollowingSide == WALL_FOLLOWING_SIDE_LEFT) {
+        tSideDegrees = 180 - WALL_FOLLOWING_SIDE_DEGREES;
+        tObliqueDegrees = 180 - WALL_FOLLOWING_OBLIQUE_DEGREES;
+    }
+
+    unsigned long tCycleStartMillis = millis();
+    uint16_t tCycleStartCount = rightEncoderMotor.DistanceCount;
+    unsigned int tSideCentimeter;
+    unsigned int tObliqueCentimeter;
+    unsigned int tForwardCentimeter;
+    // start at the end, where the servo is
+    if (abs((int) sLastServoAngleInDegrees - (int) tSideDegrees) < abs((int) sLastServoAngleInDegrees - 90)) {
+        tSideCentimeter = getWallFollowingDistance(tSideDegrees);
+        tObliqueCentimeter = getWallFollowingDistance(tObliqueDegrees);
+        tForwardCentimeter = getWallFollowingDistance(90);
+    } else {
+        tForwardCentimeter = getWallFollowingDistance(90);
+        tObliqueCentimeter = getWallFollowingDistance(tObliqueDegrees);
+        tSideCentimeter = getWallFollowingDistance(tSideDegrees);
+    }
+    sWallFollowingCycleMillis = millis() - tCycleStartMillis;
+    uint8_t tCycleCentimeter = (rightEncoderMotor.DistanceCount - tCycleStartCount) / FACTOR_CENTIMETER_TO_COUNT;
+
+    if (!sRunAutonomousDrive) {
+        stopWallFollowingSteering();
+        RobotCar.stopCar();
+        return;
+    }
+
+    /*
+     * End of wall following if anything is ahead. The next step sweeps and decides.
+     */
+    uint16_t tLookAheadCentimeter = getBrakingCentimeter() + (2 * tCycleCentimeter) + MINIMUM_DISTANCE_TO_FRONT;
+    if (checkForwardDistance(tForwardCentimeter) != TTC_RESPONSE_NONE || tForwardCentimeter < tLookAheadCentimeter
+            || !computeWallFollowingWall(tSideCentimeter, tObliqueCentimeter)) {
+        stopWallFollowingSteering();
+        return;
+    }
+
+    sWallFollowingSpeedDifference = computeWallFollowingSpeedDifference();
+    if (tForwardCentimeter > US_TIMEOUT_CENTIMETER) {
+        tForwardCentimeter = US_TIMEOUT_CENTIMETER;
+    }
+    RobotCar.changeMaxSpeedDifferential(computeGovernorSpeed(tForwardCentimeter, sWallFollowingCycleMillis),
+            sWallFollowingSpeedDifference);
+
+    updateWallFollowingPath(false);
+    if (sActualPage == PAGE_AUTOMATIC_CONTROL) {
+        drawWallFollowingInfo();
+    } else if (sActualPage == PAGE_SHOW_PATH) {
+        drawPathInfoPage();
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * WallFollowing.h
+ *
+ *  Drives along a wall or through a corridor at a target side distance. Only the side, one oblique and the forward angle
+ *  are measured, and the car is steered continuously by the speed difference of the motors instead of discrete turns.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SRC_WALLFOLLOWING_H_
+#define SRC_WALLFOLLOWING_H_
+
+#include <stdint.h>
+
+#define WALL_FOLLOWING_SIDE_NONE 0
+#define WALL_FOLLOWING_SIDE_RIGHT 1
+#define WALL_FOLLOWING_SIDE_LEFT 2
+
+// servo degrees for the right side, the left side is mirrored. 10 degree avoids detecting the own wheels.
+#define WALL_FOLLOWING_SIDE_DEGREES 10
+// 30 degree ahead of the side beam, so a parallel wall is still seen within the 70 to 110 degree reflection window
+#define WALL_FOLLOWING_OBLIQUE_DEGREES 40
+
+#define WALL_FOLLOWING_TARGET_CENTIMETER 25
+// a wall farther away than this or with a greater angle is lost
+#define WALL_FOLLOWING_MAX_WALL_CENTIMETER 60
+#define WALL_FOLLOWING_MAX_WALL_DEGREES 40
+
+/*
+ * Proportional steering. Speed difference = (angle * ANGLE_GAIN + distance error * DISTANCE_GAIN) / 16
+ * The angle term damps the distance term, so the car approaches the target distance without oscillating.
+ */
+#define WALL_FOLLOWING_ANGLE_GAIN_16 10
+#define WALL_FOLLOWING_DISTANCE_GAIN_16 16
+#define WALL_FOLLOWING_MAX_SPEED_DIFFERENCE 24
+// the curve is added to path and exploration pose as straight segments, each with this heading change
+#define WALL_FOLLOWING_PATH_SEGMENT_DEGREES 5
+
+extern bool sUseWallFollowing;
+extern uint8_t sWallFollowingSide;
+extern uint8_t sWallFollowingTargetCentimeter;
+// of the last measurement
+extern int8_t sWallFollowingAngleDegrees; // positive if the car approaches the wall
+extern uint8_t sWallFollowingDistanceCentimeter; // perpendicular to the wall
+extern int8_t sWallFollowingSpeedDifference; // positive is steering left
+extern uint16_t sWallFollowingCycleMillis;
+
+void resetWallFollowing();
+bool selectWallFollowingSide();
+bool computeWallFollowingWall(unsigned int aSideCentimeter, unsigned int aObliqueCentimeter);
+int8_t computeWallFollowingSpeedDifference();
+void startWallFollowingPath();
+void updateWallFollowingPath(bool aIsEndOfCurve);
+void stopWallFollowingSteering();
+void driveWallFollowingOneStep(int (*aCollisionDetectionFunction)());
+
+#endif /* SRC_WALLFOLLOWING_H_ */
@@ -51,6 +51,8 @@ uint8_t microstepcurve[] = {0, 25, 50, 74, 98, 120, 141, 162, 180, 197, 212, 225
 Adafruit_MotorShield::Adafruit_MotorShield(uint8_t addr) { // @suppress("Class members should be properly initialized")
   _addr = addr;
   _pwm = Adafruit_MS_PWMServoDriver(_addr);
+  _pwmDirtyMask = 0;
+  _isBatchUpdate = false;
 }
 
 
@@ -79,10 +81,16 @@ void Adafruit_MotorShield::begin(uint16_t freq, TwoWire *theWire) {
   // init PWM w/_freq
   _i2c->begin();
   _pwm.begin();
+  // set after _pwm.begin(), since this calls Wire.begin() which resets the clock to 100 kHz
+  _i2c->setClock(MOTOR_SHIELD_I2C_FREQ);
+  _i2c->setWireTimeout(MOTOR_SHIELD_I2C_TIMEOUT_MICROS, true);
   _freq = freq;
   _pwm.setPWMFreq(_freq);  // This is the maximum PWM frequency
-  for (uint8_t i=0; i<16; i++) 
-    _pwm.setPWM(i, 0, 0);
+  // turn off all pins and initialize shadow registers
+  for (uint8_t i=0; i<16; i++)
+    _pwmShadow[i] = 0;
+  _pwmDirtyMask = 0xFFFF;
+  flushPWM();
 }
 
 
@@ -95,9 +103,17 @@ void Adafruit_MotorShield::begin(uint16_t freq, TwoWire *theWire) {
 /**************************************************************************/
 void Adafruit_MotorShield::setPWM(uint8_t pin, uint16_t value) {
   if (value > 4095) {
-    _pwm.setPWM(pin, 4096, 0);
-  } else 
-    _pwm.setPWM(pin, 0, value);
+    value = 4096;
+  }
+  if (_pwmShadow[pin] == value && !(_pwmDirtyMask & (1U << pin))) {
+    // nothing changed, save the I2C transfer. A channel still dirty from a failed flush is sent again.
+    return;
+  }
+  _pwmShadow[pin] = value;
+  _pwmDirtyMask |= (1U << pin);
+  if (!_isBatchUpdate) {
+    flushPWM();
+  }
 }
 
 /**************************************************************************/
@@ -109,9 +125,68 @@ void Adafruit_MotorShield::setPWM(uint8_t pin, uint16_t value) {
 /**************************************************************************/
 void Adafruit_MotorShield::setPin(uint8_t pin, boolean value) {
   if (value == LOW)
-    _pwm.setPWM(pin, 0, 0);
+    setPWM(pin, 0);
   else
-    _pwm.setPWM(pin, 4096, 0);
+    setPWM(pin, 4096);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Defer all following setPWM() and setPin() calls until endBatchUpdate().
+    Used to send the 6 channels of both DC motors (8 to 13) in one I2C transaction.
+*/
+/**************************************************************************/
+void Adafruit_MotorShield::startBatchUpdate(void) {
+  _isBatchUpdate = true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Send all values changed since startBatchUpdate()
+*/
+/**************************************************************************/
+void Adafruit_MotorShield::endBatchUpdate(void) {
+  _isBatchUpdate = false;
+  flushPWM();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Send all changed channels using auto increment bursts.
+    A single unchanged channel between two changed ones is sent again,
+    since 4 additional bytes are cheaper than a new start, address and stop sequence.
+    The PCA9685 updates its outputs at the stop condition, so all channels of a burst change simultaneously.
+    If a burst fails or the bus timed out meanwhile, its channels stay dirty and are sent by the next flush.
+*/
+/**************************************************************************/
+void Adafruit_MotorShield::flushPWM(void) {
+  uint8_t pin = 0;
+  while (_pwmDirtyMask != 0 && pin < 16) {
+    if (!(_pwmDirtyMask & (1U << pin))) {
+      pin++;
+      continue;
+    }
+    uint8_t first = pin;
+    uint8_t last = pin;
+    for (uint8_t i = pin + 1; i < 16 && (i - first) < PCA9685_CHANNELS_PER_BURST; i++) {
+      if (_pwmDirtyMask & (1U << i)) {
+        last = i;
+      } else if (i - last > 1) {
+        // 2 unchanged channels -> end this burst
+        break;
+      }
+    }
+    uint16_t timeoutCount = _i2c->getWireTimeoutCount();
+    if (_pwm.setPWMBurst(first, (last - first) + 1, &_pwmShadow[first]) != 0
+        || _i2c->getWireTimeoutCount() != timeoutCount) {
+      // the PCA9685 may still have the old values, keep this and all following channels dirty
+      return;
+    }
+    for (uint8_t i = first; i <= last; i++) {
+      _pwmDirtyMask &= ~(1U << i);
+    }
+    pin = last + 1;
+  }
 }
 
 
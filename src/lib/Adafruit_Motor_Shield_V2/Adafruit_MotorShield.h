@@ -25,6 +25,15 @@
 
 #define MICROSTEPS 16         // 8 or 16
 
+// PCA9685 supports up to 1 MHz, use I2C fast mode for shorter motor command latency
+#ifndef MOTOR_SHIELD_I2C_FREQ
+#define MOTOR_SHIELD_I2C_FREQ 400000L
+#endif
+// Abort a transaction and recover the bus if it hangs longer (e.g. by motor EMI). 0 disables the timeout.
+#ifndef MOTOR_SHIELD_I2C_TIMEOUT_MICROS
+#define MOTOR_SHIELD_I2C_TIMEOUT_MICROS 5000
+#endif
+
 #define MOTOR1_A 2
 #define MOTOR1_B 3
 #define MOTOR2_A 1
@@ -97,7 +106,17 @@ public:
 
     void setPWM(uint8_t pin, uint16_t val);
     void setPin(uint8_t pin, boolean val);
+
+    // Collect all setPWM()/setPin() calls until endBatchUpdate() and send them in a minimal number of bursts
+    void startBatchUpdate(void);
+    void endBatchUpdate(void);
+    void flushPWM(void);
 private:
+    // Shadow of the value last sent to each channel. 0 - 4095 or 4096 for 'full on'
+    uint16_t _pwmShadow[16];
+    // Bit n set -> channel n has changed and must be sent by flushPWM()
+    uint16_t _pwmDirtyMask;
+    bool _isBatchUpdate;
     TwoWire *_i2c;
     uint8_t _addr;
     uint16_t _freq;
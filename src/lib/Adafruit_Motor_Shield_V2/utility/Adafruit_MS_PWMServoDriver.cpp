@@ -83,6 +83,30 @@ void Adafruit_MS_PWMServoDriver::setPWM(uint8_t num, uint16_t on, uint16_t off)
   WIRE.endTransmission();
 }
 
+/*
+ * Writes count adjacent channels starting at firstNum in one auto increment transaction.
+ * A value of 4096 sets the channel to 'full on', all other values are used as 'off' count with 'on' count 0.
+ * Auto increment is enabled by setPWMFreq(). count must not exceed PCA9685_CHANNELS_PER_BURST.
+ * Returns the status of endTransmission(), 0 is success.
+ */
+uint8_t Adafruit_MS_PWMServoDriver::setPWMBurst(uint8_t firstNum, uint8_t count, const uint16_t *values) {
+  WIRE.beginTransmission(_i2caddr);
+  WIRE.write(LED0_ON_L+4*firstNum);
+  for (uint8_t i = 0; i < count; i++) {
+    uint16_t on = 0;
+    uint16_t off = values[i];
+    if (off > 4095) {
+      on = 4096;
+      off = 0;
+    }
+    WIRE.write(on);
+    WIRE.write(on>>8);
+    WIRE.write(off);
+    WIRE.write(off>>8);
+  }
+  return WIRE.endTransmission();
+}
+
 uint8_t Adafruit_MS_PWMServoDriver::read8(uint8_t addr) {
   WIRE.beginTransmission(_i2caddr);
 #if ARDUINO >= 100
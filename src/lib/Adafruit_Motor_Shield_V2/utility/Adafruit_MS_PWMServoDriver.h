@@ -42,6 +42,9 @@
 #define ALLLED_OFF_L 0xFC
 #define ALLLED_OFF_H 0xFD
 
+// 1 register address byte + 4 bytes per channel must fit into the 32 byte TwoWire buffer
+#define PCA9685_CHANNELS_PER_BURST 7
+
 
 class Adafruit_MS_PWMServoDriver {
  public:
@@ -50,6 +53,7 @@ class Adafruit_MS_PWMServoDriver {
   void reset(void);
   void setPWMFreq(float freq);
   void setPWM(uint8_t num, uint16_t on, uint16_t off);
+  uint8_t setPWMBurst(uint8_t firstNum, uint8_t count, const uint16_t *values);
 
  private:
   uint8_t _i2caddr;
@@ -25,6 +25,7 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <compat/twi.h>
+#include <util/delay.h>
 #include "Arduino.h" // for digitalWrite
 
 #ifndef cbi
@@ -59,6 +60,19 @@ static volatile uint8_t twi_rxBufferIndex;
 
 static volatile uint8_t twi_error;
 
+// 0 disables the timeout
+static volatile uint32_t twi_timeout_us = 0ul;
+static volatile uint8_t twi_timed_out_flag = false;  // a timeout has been seen
+static volatile uint8_t twi_do_reset_on_timeout = false;  // reset the TWI registers and recover bus on timeout
+static volatile uint16_t twi_timeoutCount = 0;
+static volatile uint16_t twi_recoveryCount = 0;
+
+// returns true if the timeout is enabled and aStartMicros is more than twi_timeout_us ago
+static uint8_t twi_isTimeout(uint32_t aStartMicros)
+{
+  return (twi_timeout_us > 0ul) && ((micros() - aStartMicros) > twi_timeout_us);
+}
+
 /* 
  * Function twi_init
  * Desc     readys twi pins and sets twi bitrate
@@ -126,7 +140,7 @@ void twi_setAddress(uint8_t address)
  *          data: pointer to byte array
  *          length: number of bytes to read into array
  *          sendStop: Boolean indicating whether to send a stop at the end
- * Output   number of bytes read
+ * Output   number of bytes read, 0 on timeout
  */
 uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length, uint8_t sendStop)
 {
@@ -138,8 +152,12 @@ uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length, uint8_t sen
   }
 
   // wait until twi is ready, become master receiver
+  uint32_t startMicros = micros();
   while(TWI_READY != twi_state){
-    continue;
+    if(twi_isTimeout(startMicros)){
+      twi_handleTimeout(twi_do_reset_on_timeout);
+      return 0;
+    }
   }
   twi_state = TWI_MRX;
   twi_sendStop = sendStop;
@@ -177,8 +195,12 @@ uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length, uint8_t sen
     TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT) | _BV(TWSTA);
 
   // wait for read operation to complete
+  startMicros = micros();
   while(TWI_MRX == twi_state){
-    continue;
+    if(twi_isTimeout(startMicros)){
+      twi_handleTimeout(twi_do_reset_on_timeout);
+      return 0;
+    }
   }
 
   if (twi_masterBufferIndex < length)
@@ -206,6 +228,7 @@ uint8_t twi_readFrom(uint8_t address, uint8_t* data, uint8_t length, uint8_t sen
  *          2 .. address send, NACK received
  *          3 .. data send, NACK received
  *          4 .. other twi error (lost bus arbitration, bus error, ..)
+ *          5 .. timeout
  */
 uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait, uint8_t sendStop)
 {
@@ -217,8 +240,12 @@ uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait
   }
 
   // wait until twi is ready, become master transmitter
+  uint32_t startMicros = micros();
   while(TWI_READY != twi_state){
-    continue;
+    if(twi_isTimeout(startMicros)){
+      twi_handleTimeout(twi_do_reset_on_timeout);
+      return (5);
+    }
   }
   twi_state = TWI_MTX;
   twi_sendStop = sendStop;
@@ -259,8 +286,12 @@ uint8_t twi_writeTo(uint8_t address, uint8_t* data, uint8_t length, uint8_t wait
     TWCR = _BV(TWINT) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE) | _BV(TWSTA);	// enable INTs
 
   // wait for write operation to complete
+  startMicros = micros();
   while(wait && (TWI_MTX == twi_state)){
-    continue;
+    if(twi_isTimeout(startMicros)){
+      twi_handleTimeout(twi_do_reset_on_timeout);
+      return (5);
+    }
   }
   
   if (twi_error == 0xFF)
@@ -357,8 +388,18 @@ void twi_stop(void)
 
   // wait for stop condition to be exectued on bus
   // TWINT is not set after a stop condition!
+  // We may be in ISR context here, so count delays instead of using micros()
+  uint32_t counter = twi_timeout_us / 10ul;
   while(TWCR & _BV(TWSTO)){
-    continue;
+    if(twi_timeout_us > 0ul){
+      if (counter > 0ul){
+        _delay_us(10);
+        counter--;
+      } else {
+        twi_handleTimeout(twi_do_reset_on_timeout);
+        return;
+      }
+    }
   }
 
   // update twi state
@@ -380,6 +421,116 @@ void twi_releaseBus(void)
   twi_state = TWI_READY;
 }
 
+/*
+ * Function twi_setFrequency
+ * Desc     sets twi bit rate
+ * Input    frequency: SCL frequency in Hz, use TWI_FAST_MODE_FREQ for 400 kHz
+ * Output   none
+ */
+void twi_setFrequency(uint32_t frequency)
+{
+  TWBR = ((F_CPU / frequency) - 16) / 2;
+}
+
+/*
+ * Function twi_setTimeoutInMicros
+ * Desc     set a timeout for all blocking wait loops
+ * Input    timeout: timeout in microseconds, 0 disables the timeout
+ *          reset_with_timeout: true -> recover the bus and reinit the TWI hardware on timeout
+ * Output   none
+ */
+void twi_setTimeoutInMicros(uint32_t timeout, uint8_t reset_with_timeout)
+{
+  twi_timed_out_flag = false;
+  twi_timeout_us = timeout;
+  twi_do_reset_on_timeout = reset_with_timeout;
+}
+
+/*
+ * Function twi_handleTimeout
+ * Desc     counts the timeout, sets the timeout flag and optionally recovers the bus
+ * Input    reset: true -> call twi_recoverBus()
+ * Output   none
+ */
+void twi_handleTimeout(uint8_t reset)
+{
+  twi_timed_out_flag = true;
+  twi_timeoutCount++;
+
+  if (reset) {
+    twi_recoverBus();
+  } else {
+    twi_state = TWI_READY;
+  }
+}
+
+/*
+ * Function twi_recoverBus
+ * Desc     frees a bus blocked by a slave and reinitializes the TWI hardware.
+ *          A slave holding SDA low e.g. after a glitch on SCL is clocked out by up to 9 SCL pulses,
+ *          then a stop condition is generated manually. The bit rate is preserved.
+ * Input    none
+ * Output   none
+ */
+void twi_recoverBus(void)
+{
+  uint8_t previous_TWBR = TWBR;
+  uint8_t i;
+
+  twi_recoveryCount++;
+  // disable twi module to get control over the pins, keep SDA released by pullup
+  TWCR = 0;
+  pinMode(SDA, INPUT_PULLUP);
+
+  // emulate open drain SCL: low -> OUTPUT LOW, high -> INPUT_PULLUP
+  for (i = 0; i < 9 && !digitalRead(SDA); i++) {
+    pinMode(SCL, OUTPUT);
+    digitalWrite(SCL, 0);
+    _delay_us(5);
+    pinMode(SCL, INPUT_PULLUP);
+    _delay_us(5);
+  }
+
+  // generate stop condition: SDA low to high while SCL is high
+  digitalWrite(SDA, 0);
+  pinMode(SDA, OUTPUT);
+  _delay_us(5);
+  pinMode(SDA, INPUT_PULLUP);
+  _delay_us(5);
+
+  twi_init();
+  TWBR = previous_TWBR;
+}
+
+/*
+ * Function twi_manageTimeoutFlag
+ * Desc     returns true if twi has seen a timeout
+ * Input    clear_flag: true -> clear the flag
+ * Output   the value of twi_timed_out_flag when the function was called
+ */
+uint8_t twi_manageTimeoutFlag(uint8_t clear_flag)
+{
+  uint8_t flag = twi_timed_out_flag;
+  if (clear_flag){
+    twi_timed_out_flag = false;
+  }
+  return(flag);
+}
+
+/*
+ * Function twi_getTimeoutCount / twi_getRecoveryCount
+ * Desc     statistics since power on
+ */
+uint16_t twi_getTimeoutCount(void)
+{
+  return twi_timeoutCount;
+}
+
+uint16_t twi_getRecoveryCount(void)
+{
+  return twi_recoveryCount;
+}
+
 ISR(TWI_vect)
 {
   switch(TW_STATUS){
@@ -28,6 +28,11 @@
   #define TWI_FREQ 100000L
   #endif
 
+  // PCA9685 and most sensors support fast mode
+  #ifndef TWI_FAST_MODE_FREQ
+  #define TWI_FAST_MODE_FREQ 400000L
+  #endif
+
   #ifndef TWI_BUFFER_LENGTH
   #define TWI_BUFFER_LENGTH 32
   #endif
@@ -49,6 +54,13 @@
   void twi_reply(uint8_t);
   void twi_stop(void);
   void twi_releaseBus(void);
+  void twi_setFrequency(uint32_t);
+  void twi_setTimeoutInMicros(uint32_t, uint8_t);
+  void twi_handleTimeout(uint8_t);
+  void twi_recoverBus(void);
+  uint8_t twi_manageTimeoutFlag(uint8_t);
+  uint16_t twi_getTimeoutCount(void);
+  uint16_t twi_getRecoveryCount(void);
 
 #endif
 
@@ -23,6 +23,27 @@ uint8_t sTriggerOutPin;
 uint8_t sEchoInPin;
 bool isInitialized = false;
 
+int8_t sUSTemperature = US_DEFAULT_TEMPERATURE;
+uint16_t sUSCentimeterPerMicrosFactor = US_CENTIMETER_PER_MICROS_FACTOR(US_DEFAULT_TEMPERATURE);
+uint16_t sUSMicrosPerCentimeterFactor = US_MICROS_PER_CENTIMETER_FACTOR(US_DEFAULT_TEMPERATURE);
+
+/*
+ * Call it rarely, since it contains 2 long divisions
+ */
+void setUSTemperature(int8_t aTemperatureCelsius) {
+    sUSTemperature = aTemperatureCelsius;
+    sUSCentimeterPerMicrosFactor = US_CENTIMETER_PER_MICROS_FACTOR(aTemperatureCelsius);
+    sUSMicrosPerCentimeterFactor = US_MICROS_PER_CENTIMETER_FACTOR(aTemperatureCelsius);
+}
+
+USSensorStruct sUSSensors[US_MAX_NUMBER_OF_SENSORS];
+uint8_t sNumberOfUSSensors = 0;
+uint8_t sNextUSSensorIndex = 0;
+// the single sensor e.g. on the servo, has an unknown angle and is therefore neighbour of all sensors of the array
+unsigned long sMillisOfLastSingleSensorFiring;
+
+unsigned long sUSEchoWaitMicros;
+
 void initUSDistancePins(uint8_t aTriggerOutPin, uint8_t aEchoInPin) {
     sTriggerOutPin = aTriggerOutPin;
     sEchoInPin = aEchoInPin;
@@ -38,22 +59,28 @@ unsigned int getUSDistance(unsigned int aTimeoutMicros) {
     if (!isInitialized) {
         return 0;
     }
+    sMillisOfLastSingleSensorFiring = millis();
+    return getUSDistanceForPins(sTriggerOutPin, sEchoInPin, aTimeoutMicros);
+}
 
+unsigned int getUSDistanceForPins(uint8_t aTriggerOutPin, uint8_t aEchoInPin, unsigned int aTimeoutMicros) {
 // need minimum 10 usec Trigger Pulse
-    digitalWrite(sTriggerOutPin, HIGH);
+    digitalWrite(aTriggerOutPin, HIGH);
 #ifdef DEBUG
     delay(2); // to see it on scope
 #else
     delayMicroseconds(10);
 #endif
 // falling edge starts measurement
-    digitalWrite(sTriggerOutPin, LOW);
+    digitalWrite(aTriggerOutPin, LOW);
 
     /*
      * Get echo length. 58,48 us per centimeter (forth and back)
      * => 50cm gives 2900 us, 2m gives 11900 us
      */
-    unsigned long tUSPulseMicros = pulseInLong(sEchoInPin, HIGH, aTimeoutMicros);
+    unsigned long tStartMicros = micros();
+    unsigned long tUSPulseMicros = pulseInLong(aEchoInPin, HIGH, aTimeoutMicros);
+    sUSEchoWaitMicros += micros() - tStartMicros;
     if (tUSPulseMicros == 0) {
 // timeout happened
         tUSPulseMicros = aTimeoutMicros;
@@ -63,14 +90,14 @@ unsigned int getUSDistance(unsigned int aTimeoutMicros) {
 
 unsigned int getCentimeterFromUSMicroSeconds(unsigned int aDistanceMicros) {
     // The reciprocal of formula in getUSDistanceAsCentiMeterWithCentimeterTimeout()
-    return (aDistanceMicros * 10L) / 585;
+    return ((unsigned long) aDistanceMicros * sUSCentimeterPerMicrosFactor) >> 16;
 }
 
 /*
- * @return  Distance in centimeter (time in us/58.5)
- *          aTimeoutMicros/58.5 if timeout happens
+ * @return  Distance in centimeter (time in us/58.2 at 20 degree)
+ *          aTimeoutMicros/58.2 if timeout happens
  *          0 if pins are not initialized
- *          timeout of 5850 micros is equivalent to 1m
+ *          timeout of 5820 micros is equivalent to 1m
  */
 unsigned int getUSDistanceAsCentiMeter(unsigned int aTimeoutMicros) {
     unsigned int tDistanceMicros = getUSDistance(aTimeoutMicros);
@@ -81,13 +108,95 @@ unsigned int getUSDistanceAsCentiMeter(unsigned int aTimeoutMicros) {
     return (getCentimeterFromUSMicroSeconds(tDistanceMicros));
 }
 
-// 58,48 us per centimeter (forth and back)
+// 58.2 us per centimeter (forth and back) at 20 degree
 unsigned int getUSDistanceAsCentiMeterWithCentimeterTimeout(unsigned int aTimeoutCentimeter) {
 // The reciprocal of formula in getCentimeterFromUSMicroSeconds()
-    unsigned int tTimeoutMicros = ((aTimeoutCentimeter * 117) + 1) / 2; // = * 58.5 (rounded by using +1)
+    unsigned int tTimeoutMicros = (((unsigned long) aTimeoutCentimeter * sUSMicrosPerCentimeterFactor) + 0x80) >> 8;
     return getUSDistanceAsCentiMeter(tTimeoutMicros);
 }
 
+/*
+ * Only obstacles up to aHorizonCentimeter are of interest. A missing echo blocks only until the horizon.
+ * @return  Distance in centimeter or aNoEchoCentimeter if no echo was received within the horizon
+ */
+unsigned int getUSDistanceAsCentiMeterWithHorizon(unsigned int aHorizonCentimeter, unsigned int aNoEchoCentimeter) {
+    unsigned int tTimeoutMicros = (((unsigned long) aHorizonCentimeter * sUSMicrosPerCentimeterFactor) + 0x80) >> 8;
+    unsigned int tDistanceMicros = getUSDistance(tTimeoutMicros);
+    if (tDistanceMicros == 0 || tDistanceMicros >= tTimeoutMicros) {
+        return aNoEchoCentimeter;
+    }
+    return getCentimeterFromUSMicroSeconds(tDistanceMicros);
+}
+
+/*
+ * Sensor array
+ * The sensors fire round robin. A sensor is skipped, if itself or one of its neighbours has fired
+ * less than US_CROSSTALK_GUARD_MILLIS before, since it may receive the late echo of this ping.
+ * Returns index of sensor or -1 if array is full
+ */
+int8_t addUSSensor(uint8_t aTriggerOutPin, uint8_t aEchoInPin, uint8_t aAngleDegrees) {
+    if (sNumberOfUSSensors >= US_MAX_NUMBER_OF_SENSORS) {
+        return -1;
+    }
+    USSensorStruct * tSensor = &sUSSensors[sNumberOfUSSensors];
+    tSensor->TriggerOutPin = aTriggerOutPin;
+    tSensor->EchoInPin = aEchoInPin;
+    tSensor->AngleDegrees = aAngleDegrees;
+    tSensor->Centimeter = 0;
+    tSensor->MillisOfLastFiring = 0;
+    pinMode(aTriggerOutPin, OUTPUT);
+    pinMode(aEchoInPin, INPUT);
+    return sNumberOfUSSensors++;
+}
+
+bool isUSSensorReady(uint8_t aSensorIndex) {
+    unsigned long tMillis = millis();
+    if (tMillis - sMillisOfLastSingleSensorFiring < US_CROSSTALK_GUARD_MILLIS) {
+        return false;
+    }
+    uint8_t tAngle = sUSSensors[aSensorIndex].AngleDegrees;
+    for (uint8_t i = 0; i < sNumberOfUSSensors; ++i) {
+        USSensorStruct * tSensor = &sUSSensors[i];
+        if ((i == aSensorIndex || tAngle == US_SENSOR_ON_SERVO || tSensor->AngleDegrees == US_SENSOR_ON_SERVO
+                || abs((int) tAngle - (int) tSensor->AngleDegrees) <= US_CROSSTALK_NEIGHBOUR_DEGREES)
+                && tMillis - tSensor->MillisOfLastFiring < US_CROSSTALK_GUARD_MILLIS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Blocking measurement, result is stored in sUSSensors[aSensorIndex].Centimeter
+ */
+unsigned int getUSDistanceAsCentiMeterForSensor(uint8_t aSensorIndex, unsigned int aTimeoutCentimeter) {
+    USSensorStruct * tSensor = &sUSSensors[aSensorIndex];
+    unsigned int tTimeoutMicros = (((unsigned long) aTimeoutCentimeter * sUSMicrosPerCentimeterFactor) + 0x80) >> 8;
+    tSensor->MillisOfLastFiring = millis();
+    tSensor->Centimeter = getCentimeterFromUSMicroSeconds(
+            getUSDistanceForPins(tSensor->TriggerOutPin, tSensor->EchoInPin, tTimeoutMicros));
+    return tSensor->Centimeter;
+}
+
+/*
+ * Measure with the next ready sensor in round robin order.
+ * Returns index of sensor measured or -1 if no sensor is ready
+ */
+int8_t measureNextUSSensor(unsigned int aTimeoutCentimeter) {
+    for (uint8_t i = 0; i < sNumberOfUSSensors; ++i) {
+        uint8_t tIndex = sNextUSSensorIndex;
+        sNextUSSensorIndex++;
+        if (sNextUSSensorIndex >= sNumberOfUSSensors) {
+            sNextUSSensorIndex = 0;
+        }
+        if (isUSSensorReady(tIndex)) {
+            getUSDistanceAsCentiMeterForSensor(tIndex, aTimeoutCentimeter);
+            return tIndex;
+        }
+    }
+    return -1;
+}
+
 /*
  * The NON BLOCKING version only blocks for ca. 12 microseconds for code + generation of trigger pulse
  * Be sure to have the right interrupt vector below.
@@ -169,7 +278,7 @@ void startUSDistanceAsCentiMeterWithCentimeterTimeoutNonBlocking(unsigned int aT
 // need minimum 10 usec Trigger Pulse
     digitalWrite(sTriggerOutPin, HIGH);
     sUSValueIsValid = false;
-    sTimeoutMicros = aTimeoutCentimeter * 59;
+    sTimeoutMicros = ((unsigned long) aTimeoutCentimeter * sUSMicrosPerCentimeterFactor) >> 8;
     *digitalPinToPCMSK(sEchoInPin) |= bit(digitalPinToPCMSKbit(sEchoInPin));// enable pin for pin change interrupt
 // the 2 registers exists only once!
     PCICR |= bit(digitalPinToPCICRbit(sEchoInPin));// enable interrupt for the group
@@ -193,8 +302,7 @@ void startUSDistanceAsCentiMeterWithCentimeterTimeoutNonBlocking(unsigned int aT
  */
 bool isUSDistanceMeasureFinished() {
     if (sUSValueIsValid) {
-        int tDistance = ((sUSPulseMicros * 10) / 585);
-        sUSDistanceCentimeter = tDistance;
+        sUSDistanceCentimeter = getCentimeterFromUSMicroSeconds(sUSPulseMicros);
         return true;
     }
 
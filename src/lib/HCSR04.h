@@ -13,11 +13,55 @@
 
 #define US_DISTANCE_DEFAULT_TIMEOUT 20000
 // Timeout of 20000L is 3.4 meter
+
+/*
+ * Speed of sound is 331.3 + 0.606 * temperature m/s => 58.2 us per centimeter (forth and back) at 20 degree celsius.
+ * The conversion factors are computed only by setUSTemperature().
+ */
+#define US_DEFAULT_TEMPERATURE 20
+// speed of sound in 0.1 m/s
+#define US_SPEED_OF_SOUND_DECIMETER(aTemperature) (3313 + ((606 * (long)(aTemperature)) / 100))
+// centimeter = (micros * factor) >> 16
+#define US_CENTIMETER_PER_MICROS_FACTOR(aTemperature) ((US_SPEED_OF_SOUND_DECIMETER(aTemperature) * 65536L) / 200000)
+// micros = (centimeter * factor) >> 8
+#define US_MICROS_PER_CENTIMETER_FACTOR(aTemperature) ((200000L * 256) / US_SPEED_OF_SOUND_DECIMETER(aTemperature))
+
+void setUSTemperature(int8_t aTemperatureCelsius);
+extern int8_t sUSTemperature;
+
 void initUSDistancePins(uint8_t aTriggerOutPin, uint8_t aEchoInPin);
 unsigned int getUSDistance(unsigned int aTimeoutMicros = US_DISTANCE_DEFAULT_TIMEOUT);
+unsigned int getUSDistanceForPins(uint8_t aTriggerOutPin, uint8_t aEchoInPin, unsigned int aTimeoutMicros);
+unsigned int getUSDistanceAsCentiMeterWithHorizon(unsigned int aHorizonCentimeter, unsigned int aNoEchoCentimeter);
+extern unsigned long sUSEchoWaitMicros; // sum of all blocking waits for an echo
 unsigned int getCentimeterFromUSMicroSeconds(unsigned int aDistanceMicros);
 unsigned int getUSDistanceAsCentiMeter(unsigned int aTimeoutMicros = US_DISTANCE_DEFAULT_TIMEOUT);
 unsigned int getUSDistanceAsCentiMeterWithCentimeterTimeout(unsigned int aTimeoutCentimeter);
+/*
+ * Array of sensors, fixed or on a servo. The sensor of initUSDistancePins() is not part of it.
+ */
+#define US_MAX_NUMBER_OF_SENSORS 4
+// Sensors with less angle between them can receive the echo of each other
+#define US_CROSSTALK_NEIGHBOUR_DEGREES 45
+// Time after firing a sensor until its neighbours may fire. Echoes from 3.4 m need 20 ms.
+#define US_CROSSTALK_GUARD_MILLIS 20
+#define US_SENSOR_ON_SERVO 0xFF
+
+struct USSensorStruct {
+    uint8_t TriggerOutPin;
+    uint8_t EchoInPin;
+    uint8_t AngleDegrees; // 0 is right, 90 is front, 180 is left or US_SENSOR_ON_SERVO
+    unsigned int Centimeter; // result of last measurement
+    unsigned long MillisOfLastFiring;
+};
+extern USSensorStruct sUSSensors[US_MAX_NUMBER_OF_SENSORS];
+extern uint8_t sNumberOfUSSensors;
+
+int8_t addUSSensor(uint8_t aTriggerOutPin, uint8_t aEchoInPin, uint8_t aAngleDegrees);
+bool isUSSensorReady(uint8_t aSensorIndex);
+unsigned int getUSDistanceAsCentiMeterForSensor(uint8_t aSensorIndex, unsigned int aTimeoutCentimeter);
+int8_t measureNextUSSensor(unsigned int aTimeoutCentimeter);
+
 #if (defined(USE_PIN_CHANGE_INTERRUPT_D0_TO_D7) | defined(USE_PIN_CHANGE_INTERRUPT_D8_TO_D13) | defined(USE_PIN_CHANGE_INTERRUPT_A0_TO_A5))
 /*
  * Non blocking version
@@ -0,0 +1,161 @@
+/*
+ *  MPU6050.cpp
+ *
+ *  The gyroscope writes the z axis samples to its FIFO, so updateIMU() never waits for a sample.
+ *  It reads all samples available in bursts and integrates them in integer.
+ *  At standstill the samples are not integrated but used for the bias.
+ *
+ *  Wire must be initialized before, which is done by the motor shield library or by setup() for the breakout board.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "MPU6050.h"
+
+bool sIMUIsInitialized = false;
+int16_t sIMUBias16;
+bool sIMUBiasIsValid = false;
+int16_t sIMUYawRate16;
+uint8_t sIMUOverflowCount;
+
+long sIMUYawSum; // sum of the bias corrected samples in 1/16 LSB since the last getIMUYawDelta16()
+long sIMUBiasSum;
+uint8_t sIMUBiasSampleCount;
+
+static bool writeIMURegister(uint8_t aRegister, uint8_t aValue) {
+    Wire.beginTransmission(MPU6050_I2C_ADDRESS);
+    Wire.write(aRegister);
+    Wire.write(aValue);
+    return Wire.endTransmission() == 0;
+}
+
+/*
+ * Returns the number of bytes read
+ */
+static uint8_t readIMURegisters(uint8_t aRegister, uint8_t * aBuffer, uint8_t aLength) {
+    Wire.beginTransmission(MPU6050_I2C_ADDRESS);
+    Wire.write(aRegister);
+    if (Wire.endTransmission(false) != 0) {
+        return 0;
+    }
+    uint8_t tLength = Wire.requestFrom((uint8_t) MPU6050_I2C_ADDRESS, aLength);
+    for (uint8_t i = 0; i < tLength; ++i) {
+        aBuffer[i] = Wire.read();
+    }
+    return tLength;
+}
+
+/*
+ * Returns false if no MPU-6050 is found
+ */
+bool initIMU() {
+    uint8_t tWhoAmI;
+    sIMUIsInitialized = false;
+    if (readIMURegisters(MPU6050_REGISTER_WHO_AM_I, &tWhoAmI, 1) != 1 || tWhoAmI != MPU6050_I2C_ADDRESS) {
+        return false;
+    }
+    // wake up and use the x gyroscope as clock
+    if (!writeIMURegister(MPU6050_REGISTER_POWER_MANAGEMENT_1, 0x01) || !writeIMURegister(MPU6050_REGISTER_CONFIG, 0x03)
+            || !writeIMURegister(MPU6050_REGISTER_SAMPLE_RATE_DIVIDER, (1000 / MPU6050_SAMPLE_RATE_HZ) - 1)
+            || !writeIMURegister(MPU6050_REGISTER_GYRO_CONFIG, 0x00)
+            // z gyroscope only
+            || !writeIMURegister(MPU6050_REGISTER_FIFO_ENABLE, 0x10)) {
+        return false;
+    }
+    sIMUIsInitialized = true;
+    sIMUBiasIsValid = false;
+    sIMUBiasSampleCount = 0;
+    sIMUBiasSum = 0;
+    resetIMUFifo();
+    return true;
+}
+
+void resetIMUFifo() {
+    writeIMURegister(MPU6050_REGISTER_USER_CONTROL, 0x04);
+    writeIMURegister(MPU6050_REGISTER_USER_CONTROL, 0x40);
+}
+
+void handleIMUSample(int16_t aRawSample, bool aIsStandstill) {
+    if (aIsStandstill) {
+        sIMUBiasSum += aRawSample;
+        if (++sIMUBiasSampleCount == MPU6050_BIAS_SAMPLES) {
+            sIMUBias16 = (sIMUBiasSum * 16) / MPU6050_BIAS_SAMPLES;
+            sIMUBiasIsValid = true;
+            sIMUBiasSampleCount = 0;
+            sIMUBiasSum = 0;
+        }
+    } else {
+        // the samples must be consecutive
+        sIMUBiasSampleCount = 0;
+        sIMUBiasSum = 0;
+    }
+    long tSample16 = (aRawSample * 16L) - sIMUBias16;
+    sIMUYawRate16 = tSample16 / MPU6050_LSB_PER_DEGREE_PER_SECOND;
+    if (!aIsStandstill) {
+        sIMUYawSum += tSample16;
+    }
+}
+
+/*
+ * Reads all available samples, but not more than MPU6050_MAX_BURSTS_PER_UPDATE bursts.
+ * Returns the number of samples read.
+ */
+uint8_t updateIMU(bool aIsStandstill) {
+    if (!sIMUIsInitialized) {
+        return 0;
+    }
+    uint8_t tBuffer[BUFFER_LENGTH];
+    if (readIMURegisters(MPU6050_REGISTER_FIFO_COUNT_HIGH, tBuffer, 2) != 2) {
+        return 0;
+    }
+    uint16_t tFifoCount = (tBuffer[0] << 8) | tBuffer[1];
+    if (tFifoCount >= MPU6050_FIFO_SIZE) {
+        // samples are lost, the yaw is no longer valid
+        sIMUOverflowCount++;
+        resetIMUFifo();
+        return 0;
+    }
+
+    uint8_t tSamples = 0;
+    for (uint8_t tBurst = 0; tBurst < MPU6050_MAX_BURSTS_PER_UPDATE && tFifoCount >= 2; ++tBurst) {
+        uint8_t tLength = min(tFifoCount, (uint16_t) BUFFER_LENGTH) & ~0x01;
+        if (readIMURegisters(MPU6050_REGISTER_FIFO_READ_WRITE, tBuffer, tLength) != tLength) {
+            break;
+        }
+        tFifoCount -= tLength;
+        for (uint8_t i = 0; i < tLength; i += 2) {
+            handleIMUSample((tBuffer[i] << 8) | tBuffer[i + 1], aIsStandstill);
+            tSamples++;
+        }
+    }
+    return tSamples;
+}
+
+/*
+ * Reads samples until the bias is valid. The car must stand still.
+ * Returns false if there is no MPU-6050 or the bias was not learned within MPU6050_BIAS_TIMEOUT_MILLIS.
+ */
+bool learnIMUBias() {
+    unsigned long tStartMillis = millis();
+    while (!sIMUBiasIsValid) {
+        if (!sIMUIsInitialized || millis() - tStartMillis > MPU6050_BIAS_TIMEOUT_MILLIS) {
+            return false;
+        }
+        updateIMU(true);
+        delay(1000 / MPU6050_SAMPLE_RATE_HZ);
+    }
+    return true;
+}
+
+/*
+ * Yaw since the last call in 1/16 degree, positive is left
+ */
+int16_t getIMUYawDelta16() {
+    int16_t tYaw16 = sIMUYawSum / MPU6050_YAW_SUM_PER_DEGREE16;
+    // keep the fraction for the next call
+    sIMUYawSum -= tYaw16 * MPU6050_YAW_SUM_PER_DEGREE16;
+    return tYaw16;
+}
@@ -0,0 +1,54 @@
+/*
+ * MPU6050.h
+ *
+ *  Yaw rate and yaw of a MPU-6050 gyroscope on the I2C bus. Only the z axis is used.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <stdint.h>
+
+#ifndef MPU6050_H_
+#define MPU6050_H_
+
+#define MPU6050_I2C_ADDRESS 0x68
+#define MPU6050_I2C_TIMEOUT_MICROS 5000
+
+#define MPU6050_REGISTER_SAMPLE_RATE_DIVIDER 0x19
+#define MPU6050_REGISTER_CONFIG 0x1A
+#define MPU6050_REGISTER_GYRO_CONFIG 0x1B
+#define MPU6050_REGISTER_FIFO_ENABLE 0x23
+#define MPU6050_REGISTER_USER_CONTROL 0x6A
+#define MPU6050_REGISTER_POWER_MANAGEMENT_1 0x6B
+#define MPU6050_REGISTER_FIFO_COUNT_HIGH 0x72
+#define MPU6050_REGISTER_FIFO_READ_WRITE 0x74
+#define MPU6050_REGISTER_WHO_AM_I 0x75
+
+#define MPU6050_FIFO_SIZE 1024
+// with the digital low pass filter of 44 Hz the gyroscope output rate is 1 kHz
+#define MPU6050_SAMPLE_RATE_HZ 50
+// at full scale range of +/-250 degree per second
+#define MPU6050_LSB_PER_DEGREE_PER_SECOND 131
+// yaw sum for 1/16 degree
+#define MPU6050_YAW_SUM_PER_DEGREE16 ((long) MPU6050_LSB_PER_DEGREE_PER_SECOND * MPU6050_SAMPLE_RATE_HZ)
+
+// the bias is the mean of this number of consecutive samples at standstill
+#define MPU6050_BIAS_SAMPLES 64
+// 64 samples take 1280 ms at 50 Hz
+#define MPU6050_BIAS_TIMEOUT_MILLIS 2000
+// one burst is limited by the 32 byte buffer of Wire i.e. 16 samples
+#define MPU6050_MAX_BURSTS_PER_UPDATE 4
+
+extern bool sIMUIsInitialized;
+extern int16_t sIMUBias16; // in 1/16 LSB
+extern bool sIMUBiasIsValid;
+extern int16_t sIMUYawRate16; // of the last sample in 1/16 degree per second, positive is left
+extern uint8_t sIMUOverflowCount;
+
+bool initIMU();
+void resetIMUFifo();
+uint8_t updateIMU(bool aIsStandstill);
+bool learnIMUBias();
+int16_t getIMUYawDelta16();
+
+#endif // MPU6050_H_
@@ -22,6 +22,7 @@
 #include <Arduino.h>
 #include <CarMotorControl.h>
 #include <EncoderMotor.h>
+#include <MotorInfoStorage.h>
 
 #include "RobotCarGui.h"
 
@@ -45,31 +46,71 @@ void CarMotorControl::init(uint8_t aPinFor2WDDetection) {
     EncoderMotor::enableBothInterruptsOnBothEdges();
 
     is2WDCar = !digitalRead(aPinFor2WDDetection);
+    readTurnFactorsFromEeprom();
+    readStopModelsFromEeprom();
 }
 
 void CarMotorControl::setSpeedCompensated(uint8_t aSpeed) {
+    TB6612DcMotor::startBatchUpdate();
     rightEncoderMotor.setSpeedCompensated(aSpeed);
     leftEncoderMotor.setSpeedCompensated(aSpeed);
+    TB6612DcMotor::endBatchUpdate();
+}
+
+void CarMotorControl::changeMaxSpeed(uint8_t aMaxSpeed) {
+    TB6612DcMotor::startBatchUpdate();
+    rightEncoderMotor.changeMaxSpeed(aMaxSpeed);
+    leftEncoderMotor.changeMaxSpeed(aMaxSpeed);
+    TB6612DcMotor::endBatchUpdate();
+}
+
+/*
+ * Steering while driving. aSpeedDifference > 0 -> right motor faster -> curve to the left.
+ * The speed compensation is kept. synchronizeMotor() must not be called while steering, since the counts differ by intention.
+ * Near MaxSpeed both speeds are lowered, so the faster side is not clipped and the full difference is applied.
+ */
+void CarMotorControl::changeMaxSpeedDifferential(uint8_t aMaxSpeed, int8_t aSpeedDifference) {
+    int16_t tRightSpeed = aMaxSpeed + (aSpeedDifference / 2);
+    int16_t tLeftSpeed = tRightSpeed - aSpeedDifference;
+    int16_t tExcess = max(tRightSpeed - rightEncoderMotor.MaxSpeed, tLeftSpeed - leftEncoderMotor.MaxSpeed);
+    if (tExcess > 0) {
+        tRightSpeed -= tExcess;
+        tLeftSpeed -= tExcess;
+    }
+    TB6612DcMotor::startBatchUpdate();
+    rightEncoderMotor.changeMaxSpeed(constrain(tRightSpeed, 0, rightEncoderMotor.MaxSpeed));
+    leftEncoderMotor.changeMaxSpeed(constrain(tLeftSpeed, 0, leftEncoderMotor.MaxSpeed));
+    TB6612DcMotor::endBatchUpdate();
 }
 
 void CarMotorControl::activateMotors() {
+    TB6612DcMotor::startBatchUpdate();
     rightEncoderMotor.activate();
     leftEncoderMotor.activate();
+    TB6612DcMotor::endBatchUpdate();
 }
 
 void CarMotorControl::shutdownMotors(bool doBrake) {
+    TB6612DcMotor::startBatchUpdate();
     rightEncoderMotor.shutdownMotor(doBrake);
     leftEncoderMotor.shutdownMotor(doBrake);
+    TB6612DcMotor::endBatchUpdate();
 }
 
 void CarMotorControl::updateMotors() {
+    updateMotorInfoStorage();
+    updateStopModels();
+    TB6612DcMotor::startBatchUpdate();
     rightEncoderMotor.updateMotor();
     leftEncoderMotor.updateMotor();
+    TB6612DcMotor::endBatchUpdate();
 }
 
 void CarMotorControl::resetAndShutdownMotors() {
+    TB6612DcMotor::startBatchUpdate();
     rightEncoderMotor.resetAndShutdown();
     leftEncoderMotor.resetAndShutdown();
+    TB6612DcMotor::endBatchUpdate();
     isDirectionForward = true;
 }
 
@@ -78,8 +119,10 @@ void CarMotorControl::resetAndShutdownMotors() {
  */
 void CarMotorControl::setDirection(bool goForward) {
     isDirectionForward = goForward;
+    TB6612DcMotor::startBatchUpdate();
     rightEncoderMotor.setDirection(goForward);
     leftEncoderMotor.setDirection(goForward);
+    TB6612DcMotor::endBatchUpdate();
 }
 
 /*
@@ -104,13 +147,22 @@ void CarMotorControl::goDistanceCentimeter(int aDistanceCentimeter, void (*aLoop
  * Start motor for "infinite" distance and then blocking wait until both motors are at full speed
  */
 void CarMotorControl::startAndWaitForFullSpeed() {
+    startAndWaitForFullSpeed(0);
+}
+
+/*
+ * Same as above, but ramp up only to aMaxSpeed. 0 ramps up to MaxSpeed of each motor.
+ */
+void CarMotorControl::startAndWaitForFullSpeed(uint8_t aMaxSpeed) {
     initGoDistanceCentimeter(3200);
+    if (aMaxSpeed != 0) {
+        changeMaxSpeed(aMaxSpeed);
+    }
     /*
      * blocking wait for start
      */
     do {
-        rightEncoderMotor.updateMotor();
-        leftEncoderMotor.updateMotor();
+        updateMotors();
     } while (rightEncoderMotor.State != MOTOR_STATE_FULL_SPEED || leftEncoderMotor.State != MOTOR_STATE_FULL_SPEED);
 }
 
@@ -132,8 +184,7 @@ void CarMotorControl::stopCar() {
      * blocking wait for stop
      */
     do {
-        rightEncoderMotor.updateMotor();
-        leftEncoderMotor.updateMotor();
+        updateMotors();
     } while (!isStopped());
 }
 
@@ -142,8 +193,7 @@ void CarMotorControl::stopCar() {
  */
 void CarMotorControl::waitUntilCarStopped(void (*aLoopCallback)(void)) {
     do {
-        rightEncoderMotor.updateMotor();
-        leftEncoderMotor.updateMotor();
+        updateMotors();
         if (aLoopCallback != NULL) {
             aLoopCallback();
         }
@@ -155,8 +205,7 @@ void CarMotorControl::waitUntilCarStopped(void (*aLoopCallback)(void)) {
  */
 void CarMotorControl::waitUntilCarStopped() {
     do {
-        rightEncoderMotor.updateMotor();
-        leftEncoderMotor.updateMotor();
+        updateMotors();
     } while (!isStopped());
 }
 
@@ -183,6 +232,98 @@ void CarMotorControl::rotateCar(int16_t aRotationDegrees, uint8_t aTurnDirection
     }
 }
 
+uint8_t CarMotorControl::getTurnFactorIndex(int16_t aRotationDegrees, bool aUseSlowSpeed) {
+    uint8_t tIndex = TURN_FACTOR_LEFT_SLOW;
+    if (aRotationDegrees < 0) {
+        tIndex = TURN_FACTOR_RIGHT_SLOW;
+    }
+    if (!aUseSlowSpeed) {
+        tIndex += TURN_FACTOR_LEFT;
+    }
+    return tIndex;
+}
+
+uint16_t CarMotorControl::getDefaultTurnFactor() {
+    if (is2WDCar) {
+        return (FACTOR_DEGREE_TO_COUNT_2WD_CAR * TURN_FACTOR_SCALE) + 0.5;
+    }
+    return (FACTOR_DEGREE_TO_COUNT_4WD_CAR * TURN_FACTOR_SCALE) + 0.5;
+}
+
+/*
+ * Values which differ more than 50 percent from the default factor are invalid
+ */
+void CarMotorControl::readTurnFactorsFromEeprom() {
+    EepromTurnFactorStruct tEepromTurnFactors;
+    eeprom_read_block((void*) &tEepromTurnFactors, (void*) EEPROM_TURN_FACTORS_ADDRESS, sizeof(EepromTurnFactorStruct));
+    uint16_t tDefaultFactor = getDefaultTurnFactor();
+    for (uint8_t i = 0; i < NUMBER_OF_TURN_FACTORS; ++i) {
+        uint16_t tFactor = tEepromTurnFactors.TurnFactors[i];
+        if (tFactor > tDefaultFactor / 2 && tFactor < tDefaultFactor + tDefaultFactor / 2) {
+            TurnFactors[i] = tFactor;
+        } else {
+            TurnFactors[i] = tDefaultFactor;
+        }
+    }
+}
+
+void CarMotorControl::writeTurnFactorsToEeprom() {
+    EepromTurnFactorStruct tEepromTurnFactors;
+    memcpy(tEepromTurnFactors.TurnFactors, TurnFactors, sizeof(TurnFactors));
+    eeprom_write_block((void*) &tEepromTurnFactors, (void*) EEPROM_TURN_FACTORS_ADDRESS, sizeof(EepromTurnFactorStruct));
+}
+
+/*
+ * Greater values are invalid
+ */
+void CarMotorControl::readStopModelsFromEeprom() {
+    EncoderMotor * tMotors[2] = { &leftEncoderMotor, &rightEncoderMotor };
+    for (uint8_t tMotorIndex = 0; tMotorIndex < 2; ++tMotorIndex) {
+        EepromStopModelStruct tEepromStopModel;
+        uint16_t tAddress = EEPROM_STOP_MODEL_ADDRESS + (tMotors[tMotorIndex]->EncoderMotorNumber * sizeof(EepromStopModelStruct));
+        eeprom_read_block((void*) &tEepromStopModel, (void*) tAddress, sizeof(EepromStopModelStruct));
+        uint8_t * tOvershoot = &tEepromStopModel.Overshoot[0][0];
+        for (uint8_t i = 0; i < STOP_MODEL_VOLTAGE_BINS * STOP_MODEL_SPEED_BINS; ++i) {
+            if (tOvershoot[i] > STOP_MODEL_MAX_OVERSHOOT_COUNT * STOP_MODEL_FRACTION) {
+                tOvershoot[i] = STOP_MODEL_INVALID;
+            }
+        }
+        memcpy(tMotors[tMotorIndex]->StopModel, tEepromStopModel.Overshoot, sizeof(tEepromStopModel.Overshoot));
+        tMotors[tMotorIndex]->StopModelHasChanged = false;
+    }
+}
+
+/*
+ * Only if something was learned since last write.
+ * A stop, which is not yet learned because the wheels are still moving, is written later by updateStopModels().
+ */
+void CarMotorControl::writeStopModelsToEeprom() {
+    EncoderMotor * tMotors[2] = { &leftEncoderMotor, &rightEncoderMotor };
+    StopModelWriteIsPending = false;
+    for (uint8_t tMotorIndex = 0; tMotorIndex < 2; ++tMotorIndex) {
+        if (tMotors[tMotorIndex]->SpeedAtRampDownStart != 0) {
+            StopModelWriteIsPending = true;
+        }
+        if (tMotors[tMotorIndex]->StopModelHasChanged) {
+            uint16_t tAddress = EEPROM_STOP_MODEL_ADDRESS
+                    + (tMotors[tMotorIndex]->EncoderMotorNumber * sizeof(EepromStopModelStruct));
+            eeprom_update_block((void*) tMotors[tMotorIndex]->StopModel, (void*) tAddress, sizeof(EepromStopModelStruct));
+            tMotors[tMotorIndex]->StopModelHasChanged = false;
+        }
+    }
+}
+
+/*
+ * To be called regularly, also if the motors are not updated.
+ * Learns the last stops when the wheels are at rest and then writes a pending stop model.
+ */
+void CarMotorControl::updateStopModels() {
+    bool tRightIsLearned = rightEncoderMotor.learnStopModelAtRest();
+    if (leftEncoderMotor.learnStopModelAtRest() && tRightIsLearned && StopModelWriteIsPending) {
+        writeStopModelsToEeprom();
+    }
+}
+
 /**
  * Set distances and speed for 2 motors to turn the requested angle
  * @param  if aUseSlowSpeed is true then use slower speed (1.5 times MinSpeed) for rotation to be more exact
@@ -190,15 +331,10 @@ void CarMotorControl::rotateCar(int16_t aRotationDegrees, uint8_t aTurnDirection
 void CarMotorControl::initRotateCar(int16_t aRotationDegrees, uint8_t aTurnDirection, bool aUseSlowSpeed) {
     int tDistanceCountRight;
     int tDistanceCountLeft;
-    float tFactor;
-    if (is2WDCar) {
-        tFactor = FACTOR_DEGREE_TO_COUNT_2WD_CAR;
-    } else {
-        tFactor = FACTOR_DEGREE_TO_COUNT_4WD_CAR;
-    }
+    uint16_t tFactor = TurnFactors[getTurnFactorIndex(aRotationDegrees, aUseSlowSpeed)];
     if (aRotationDegrees > 0) {
 // turn left, default is TURN_FORWARD
-        tDistanceCountRight = (aRotationDegrees * tFactor) + 0.5;
+        tDistanceCountRight = (((long) aRotationDegrees * tFactor) + (TURN_FACTOR_SCALE / 2)) / TURN_FACTOR_SCALE;
         tDistanceCountLeft = 0;
         if (aTurnDirection == TURN_IN_PLACE) {
             tDistanceCountLeft = -tDistanceCountRight / 2;
@@ -206,7 +342,7 @@ void CarMotorControl::initRotateCar(int16_t aRotationDegrees, uint8_t aTurnDirec
         }
     } else {
 // turn right, default is TURN_FORWARD
-        tDistanceCountLeft = (-aRotationDegrees * tFactor) + 0.5;
+        tDistanceCountLeft = (((long) -aRotationDegrees * tFactor) + (TURN_FACTOR_SCALE / 2)) / TURN_FACTOR_SCALE;
         tDistanceCountRight = 0;
         if (aTurnDirection == TURN_IN_PLACE) {
             tDistanceCountRight = -tDistanceCountLeft / 2;
@@ -241,6 +377,33 @@ void CarMotorControl::rotateCar(int16_t aRotationDegrees, void (*aLoopCallback)(
     }
 }
 
+/**
+ * Rotation in place, which closes the loop over an independent measurement of the real rotation.
+ * After the rotation by encoder count, the remaining error is corrected by rotations at slow speed.
+ * An error smaller than the rotation for one count of each wheel is corrected by a pulse of one count, if it is more than half of it.
+ * @param  aGetRealRotationDegrees returns the real rotation since the start of this function or false if not available
+ * @return the last measured real rotation or aRotationDegrees if no measurement was available
+ */
+int16_t CarMotorControl::rotateCarClosedLoop(int16_t aRotationDegrees, bool (*aGetRealRotationDegrees)(int16_t * aRealRotationDegrees),
+        void (*aLoopCallback)(void)) {
+    rotateCar(aRotationDegrees, aLoopCallback, TURN_IN_PLACE);
+    int16_t tRealRotationDegrees = aRotationDegrees;
+    for (uint8_t i = 0; aGetRealRotationDegrees(&tRealRotationDegrees); ++i) {
+        int16_t tErrorDegrees = aRotationDegrees - tRealRotationDegrees;
+        uint16_t tFactor = TurnFactors[getTurnFactorIndex(tErrorDegrees, true)];
+        int16_t tPulseDegrees = ((2 * TURN_FACTOR_SCALE) + (tFactor / 2)) / tFactor;
+        if (abs(tErrorDegrees) <= TURN_CLOSED_LOOP_TOLERANCE_DEGREES || abs(tErrorDegrees) < (tPulseDegrees / 2)
+                || i == TURN_CLOSED_LOOP_MAX_CORRECTIONS) {
+            break;
+        }
+        if (abs(tErrorDegrees) < tPulseDegrees) {
+            tErrorDegrees = (tErrorDegrees > 0) ? tPulseDegrees : -tPulseDegrees;
+        }
+        rotateCar(tErrorDegrees, aLoopCallback, TURN_IN_PLACE, true);
+    }
+    return tRealRotationDegrees;
+}
+
 // ISR for PIN PD2 / RIGHT
 ISR(INT0_vect) {
     rightEncoderMotor.handleEncoderInterrupt();
@@ -21,6 +21,30 @@
 #define FACTOR_DEGREE_TO_COUNT_2WD_CAR 0.4277777
 #define FACTOR_DEGREE_TO_COUNT_4WD_CAR 0.8
 
+/*
+ * Turn factors in count per TURN_FACTOR_SCALE degrees. Can be calibrated for each direction and for slow and normal speed.
+ */
+#define TURN_FACTOR_SCALE 10000
+#define TURN_FACTOR_LEFT_SLOW 0
+#define TURN_FACTOR_RIGHT_SLOW 1
+#define TURN_FACTOR_LEFT 2
+#define TURN_FACTOR_RIGHT 3
+#define NUMBER_OF_TURN_FACTORS 4
+// stored behind the EepromMotorInfoStruct of both motors
+#define EEPROM_TURN_FACTORS_ADDRESS (2 * sizeof(EepromMotorInfoStruct))
+// stop models of left and right motor are stored behind the turn factors
+#define EEPROM_STOP_MODEL_ADDRESS (EEPROM_TURN_FACTORS_ADDRESS + sizeof(EepromTurnFactorStruct))
+// the record ring of MotorInfoStorage is behind the stop models. The EepromMotorInfoStruct at address 0 is only read as fallback.
+#define EEPROM_MOTOR_INFO_RING_ADDRESS (EEPROM_STOP_MODEL_ADDRESS + (2 * sizeof(EepromStopModelStruct)))
+
+// closed loop turns stop correcting if the error is not greater than this
+#define TURN_CLOSED_LOOP_TOLERANCE_DEGREES 3
+#define TURN_CLOSED_LOOP_MAX_CORRECTIONS 3
+
+struct EepromTurnFactorStruct {
+    uint16_t TurnFactors[NUMBER_OF_TURN_FACTORS];
+};
+
 #define TURN_FORWARD 0
 #define TURN_BACKWARD 1
 #define TURN_IN_PLACE 2
@@ -37,6 +61,8 @@ public:
      * Functions, which directly call EncoderMotor functions for both motors
      */
     void setSpeedCompensated(uint8_t aSpeed);
+    void changeMaxSpeed(uint8_t aMaxSpeed);
+    void changeMaxSpeedDifferential(uint8_t aMaxSpeed, int8_t aSpeedDifference);
     //This stops motors
     void setDirection(bool goForward);
     void updateMotors();
@@ -62,15 +88,25 @@ public:
     /*
      * Rotation with wait
      */
+    uint8_t getTurnFactorIndex(int16_t aRotationDegrees, bool aUseSlowSpeed);
+    uint16_t getDefaultTurnFactor();
+    void readTurnFactorsFromEeprom();
+    void writeTurnFactorsToEeprom();
+    void readStopModelsFromEeprom();
+    void writeStopModelsToEeprom();
+    void updateStopModels();
     void initRotateCar(int16_t aRotationDegrees, uint8_t aTurnDirection, bool aUseSlowSpeed = true);
     void rotateCar(int16_t aRotationDegrees, uint8_t aTurnDirection, bool aUseSlowSpeed = true);
     void rotateCar(int16_t aRotationDegrees, void (*aLoopCallback)(void), uint8_t aTurnDirection = TURN_IN_PLACE,
             bool aUseSlowSpeed = true);
+    int16_t rotateCarClosedLoop(int16_t aRotationDegrees, bool (*aGetRealRotationDegrees)(int16_t * aRealRotationDegrees),
+            void (*aLoopCallback)(void));
 
     /*
      * Start/Stop with wait
      */
     void startAndWaitForFullSpeed();
+    void startAndWaitForFullSpeed(uint8_t aMaxSpeed);
     void stopCar();
     void waitUntilCarStopped();
     void waitUntilCarStopped(void (*aLoopCallback)(void));
@@ -80,6 +116,10 @@ public:
     bool isDirectionForward;
     //
     bool is2WDCar;
+    // set if a stop was not learned at the last writeStopModelsToEeprom()
+    bool StopModelWriteIsPending;
+    // count per TURN_FACTOR_SCALE degrees
+    uint16_t TurnFactors[NUMBER_OF_TURN_FACTORS];
 };
 
 extern EncoderMotor rightEncoderMotor;
@@ -23,12 +23,14 @@
 
 #include <Arduino.h>
 #include <EncoderMotor.h>
+#include <MotorInfoStorage.h>
 
 #include "RobotCarGui.h"
 
 bool EncoderMotor::ValuesHaveChanged; // for printing
 bool EncoderMotor::EnableValuesPrint = true;
 volatile bool EncoderMotor::DistanceTickCounterHasChanged;
+uint8_t EncoderMotor::SupplyDeciVolt = 0;
 
 /*
  * The list version saves 100 bytes and is more flexible, compared with the array version
@@ -137,16 +139,33 @@ void EncoderMotor::updateMotor() {
     // have to check since skipping MOTOR_STATE_FULL_SPEED must be possible
     if (State == MOTOR_STATE_FULL_SPEED) {
         /*
-         * Wait until ramp down count is reached
+         * Wait until ramp down count is reached. Ramp down and target are moved forward by the predicted overshoot.
          */
-        if (DistanceCount >= NextChangeMaxTargetCount) {
-            NextChangeMaxTargetCount++;
+        uint8_t tOvershootCount = 0;
+        bool tStopModelIsValid = getStopModelOvershoot(ActualSpeed, &tOvershootCount);
+        if (DistanceCount >= TargetDistanceCount) {
+            tOvershootCount = 0;
+        } else if (tOvershootCount >= TargetDistanceCount - DistanceCount) {
+            tOvershootCount = TargetDistanceCount - DistanceCount - 1;
+        }
+        if (DistanceCount + tOvershootCount >= NextChangeMaxTargetCount) {
+            TargetDistanceCount -= tOvershootCount;
+            StopModelTargetCount = TargetDistanceCount;
+            SpeedAtRampDownStart = ActualSpeed;
+            NextChangeMaxTargetCount = DistanceCount + 1;
             //  --> RAMP_DOWN
             State = MOTOR_STATE_RAMP_DOWN;
-            /*
-             * Ramp to reach MinSpeed after 1/2 of remaining distance
-             */
-            RampDeltaPerDistanceCount = ((ActualSpeed - StopSpeed) * 2) / ((TargetDistanceCount - DistanceCount)) + 1;
+            if (tStopModelIsValid) {
+                /*
+                 * The overshoot is known, so ramp to reach StopSpeed just at target count without slow final approach
+                 */
+                RampDeltaPerDistanceCount = (ActualSpeed - StopSpeed) / ((TargetDistanceCount - DistanceCount)) + 1;
+            } else {
+                /*
+                 * Ramp to reach MinSpeed after 1/2 of remaining distance
+                 */
+                RampDeltaPerDistanceCount = ((ActualSpeed - StopSpeed) * 2) / ((TargetDistanceCount - DistanceCount)) + 1;
+            }
             // brake
             if (ActualSpeed > RampDeltaPerDistanceCount) {
                 ActualSpeed -= RampDeltaPerDistanceCount;
@@ -194,6 +213,8 @@ void EncoderMotor::updateMotor() {
      */
     if (State != MOTOR_STATE_STOPPED && tMillis > (DistanceTickLastMillis + RAMP_DOWN_TIMEOUT_MILLIS)) {
         SpeedAtTargetCountReached = ActualSpeed;
+        // blocked, nothing to learn
+        SpeedAtRampDownStart = 0;
         shutdownMotor(true);
     }
 }
@@ -254,7 +275,8 @@ void EncoderMotor::synchronizeMotor(EncoderMotor * aOtherMotorControl, uint16_t
             }
 
             if (ValuesHaveChanged && State == MOTOR_STATE_FULL_SPEED) {
-                writeEeprom();
+                // committed later by updateMotorInfoStorage()
+                markMotorInfoChanged();
             }
         }
     }
@@ -278,7 +300,7 @@ void EncoderMotor::calibrate() {
     /*
      * increase motor speed by 1 until motor moves
      */
-    for (uint8_t tSpeed = 20; tSpeed != 0xFF; ++tSpeed) {
+    for (uint8_t tSpeed = CALIBRATE_START_SPEED; tSpeed != 0xFF; ++tSpeed) {
         tEncoderMotorControlPointer = sMotorControlListStart;
 // walk through list
         while (tEncoderMotorControlPointer != NULL) {
@@ -340,6 +362,7 @@ void EncoderMotor::initGoDistanceCount(int aDistanceCount) {
     }
 
     if (State == MOTOR_STATE_STOPPED) {
+        learnStopModel();
         ActualMaxSpeed = MaxSpeed - SpeedCompensation;
         /*
          * Start the motor and compensate for last distance delta
@@ -362,6 +385,26 @@ void EncoderMotor::initGoDistanceCount(int aDistanceCount) {
     LastTargetDistanceCount = TargetDistanceCount;
 }
 
+/*
+ * Sets ActualMaxSpeed and adjusts ActualSpeed if running at full speed or if ramping up above the new value.
+ * Ramp down is not affected. Values below StopSpeed are clipped.
+ */
+void EncoderMotor::changeMaxSpeed(uint8_t aMaxSpeed) {
+    if (aMaxSpeed < StopSpeed) {
+        aMaxSpeed = StopSpeed;
+    }
+    if (aMaxSpeed > SpeedCompensation) {
+        aMaxSpeed -= SpeedCompensation;
+    }
+    ActualMaxSpeed = aMaxSpeed;
+    if ((State == MOTOR_STATE_FULL_SPEED && ActualSpeed != ActualMaxSpeed)
+            || (State == MOTOR_STATE_RAMP_UP && ActualSpeed > ActualMaxSpeed)) {
+        ActualSpeed = ActualMaxSpeed;
+        setSpeed(ActualSpeed);
+        ValuesHaveChanged = true;
+    }
+}
+
 void EncoderMotor::setDirection(bool goForward) {
     isDirectionForward = goForward;
     activate();
@@ -404,8 +447,11 @@ void EncoderMotor::resetAndShutdown() {
  */
 void EncoderMotor::readEeprom() {
     EepromMotorInfoStruct tEepromMotorInfo;
-    eeprom_read_block((void*) &tEepromMotorInfo, (void*) (EncoderMotorNumber * sizeof(EepromMotorInfoStruct)),
-            sizeof(EepromMotorInfoStruct));
+    if (!readMotorInfo(EncoderMotorNumber, &tEepromMotorInfo)) {
+        // no record in the ring yet, take the values stored by older versions
+        eeprom_read_block((void*) &tEepromMotorInfo, (void*) (EncoderMotorNumber * sizeof(EepromMotorInfoStruct)),
+                sizeof(EepromMotorInfoStruct));
+    }
     /*
      * Plausibility check for values
      */
@@ -432,15 +478,107 @@ void EncoderMotor::readEeprom() {
     ValuesHaveChanged = true;
 }
 
+/*
+ * Does not block. The values of all motors are written as one record by the next calls of updateMotorInfoStorage(),
+ * so calling it for each motor results in only one commit.
+ */
 void EncoderMotor::writeEeprom() {
-    EepromMotorInfoStruct tEepromMotorInfo;
-    tEepromMotorInfo.MinSpeed = MinSpeed;
-    tEepromMotorInfo.StopSpeed = StopSpeed;
-    tEepromMotorInfo.MaxSpeed = MaxSpeed;
-    tEepromMotorInfo.SpeedCompensation = SpeedCompensation;
+    requestMotorInfoCommit();
+}
+
+/*
+ * Stop model
+ */
+uint8_t EncoderMotor::getStopModelVoltageIndex() {
+    if (SupplyDeciVolt == 0) {
+        // not known
+        return 1;
+    }
+    if (SupplyDeciVolt < STOP_MODEL_LOW_DECI_VOLT) {
+        return 0;
+    }
+    if (SupplyDeciVolt < STOP_MODEL_HIGH_DECI_VOLT) {
+        return 1;
+    }
+    return 2;
+}
+
+/*
+ * Returns false if nothing is learned for this speed and voltage
+ */
+bool EncoderMotor::getStopModelOvershoot(uint8_t aSpeed, uint8_t * aOvershootCount) {
+    uint8_t * tOvershootRow = StopModel[getStopModelVoltageIndex()];
+    const uint8_t tBinWidth = 1 << STOP_MODEL_SPEED_BIN_SHIFT;
+    // position relative to the center of the first bin
+    int16_t tPosition = (int16_t) aSpeed - (tBinWidth / 2);
+    uint8_t tLowIndex = 0;
+    uint8_t tHighWeight = 0;
+    if (tPosition > 0) {
+        tLowIndex = tPosition >> STOP_MODEL_SPEED_BIN_SHIFT;
+        tHighWeight = tPosition & (tBinWidth - 1);
+        if (tLowIndex >= STOP_MODEL_SPEED_BINS - 1) {
+            tLowIndex = STOP_MODEL_SPEED_BINS - 1;
+            tHighWeight = 0;
+        }
+    }
+    uint8_t tLowOvershoot = tOvershootRow[tLowIndex];
+    uint8_t tHighOvershoot = tLowOvershoot;
+    if (tHighWeight > 0) {
+        tHighOvershoot = tOvershootRow[tLowIndex + 1];
+    }
+    if (tLowOvershoot == STOP_MODEL_INVALID) {
+        if (tHighOvershoot == STOP_MODEL_INVALID) {
+            return false;
+        }
+        tLowOvershoot = tHighOvershoot;
+    } else if (tHighOvershoot == STOP_MODEL_INVALID) {
+        tHighOvershoot = tLowOvershoot;
+    }
+    uint16_t tOvershoot = ((tLowOvershoot * (tBinWidth - tHighWeight)) + (tHighOvershoot * tHighWeight))
+            >> STOP_MODEL_SPEED_BIN_SHIFT;
+    *aOvershootCount = (tOvershoot + (STOP_MODEL_FRACTION / 2)) / STOP_MODEL_FRACTION;
+    return true;
+}
+
+/*
+ * To be called after the motor has come to rest. The counts after the (corrected) target count are the overshoot.
+ */
+void EncoderMotor::learnStopModel() {
+    uint8_t tSpeedAtRampDownStart = SpeedAtRampDownStart;
+    // this stop is handled now, even if it is not learned
+    SpeedAtRampDownStart = 0;
+    if (tSpeedAtRampDownStart == 0 || DistanceCount < StopModelTargetCount) {
+        return;
+    }
+    uint16_t tOvershootCount = DistanceCount - StopModelTargetCount;
+    uint8_t tSpeedIndex = tSpeedAtRampDownStart >> STOP_MODEL_SPEED_BIN_SHIFT;
+    if (tOvershootCount > STOP_MODEL_MAX_OVERSHOOT_COUNT) {
+        return;
+    }
+    if (tSpeedIndex >= STOP_MODEL_SPEED_BINS) {
+        tSpeedIndex = STOP_MODEL_SPEED_BINS - 1;
+    }
+    uint8_t * tCell = &StopModel[getStopModelVoltageIndex()][tSpeedIndex];
+    uint8_t tOvershoot = tOvershootCount * STOP_MODEL_FRACTION;
+    if (*tCell == STOP_MODEL_INVALID) {
+        *tCell = tOvershoot;
+    } else {
+        // low pass
+        *tCell += ((int) tOvershoot - (int) *tCell) / (1 << STOP_MODEL_LEARN_SHIFT);
+    }
+    StopModelHasChanged = true;
+}
 
-    eeprom_write_block((void*) &tEepromMotorInfo, (void*) (EncoderMotorNumber * sizeof(EepromMotorInfoStruct)),
-            sizeof(EepromMotorInfoStruct));
+/*
+ * Learns the last stop after the wheels have come to rest.
+ * Returns true if there is no stop left to learn.
+ */
+bool EncoderMotor::learnStopModelAtRest() {
+    if (SpeedAtRampDownStart != 0 && State == MOTOR_STATE_STOPPED
+            && millis() - DistanceTickLastMillis > STOP_MODEL_REST_MILLIS) {
+        learnStopModel();
+    }
+    return SpeedAtRampDownStart == 0;
 }
 
 void EncoderMotor::handleEncoderInterrupt() {
@@ -453,6 +591,11 @@ void EncoderMotor::handleEncoderInterrupt() {
         DistanceTickLastMillis = tMillis;
         DistanceCount++;
         LastRideDistanceCount++;
+        if (isDirectionForward) {
+            EncoderPosition++;
+        } else {
+            EncoderPosition--;
+        }
         ActualVelocity = VELOCITY_SCALE_VALUE / tDeltaMillis;
         DistanceTickCounterHasChanged = true;
     }
@@ -504,11 +647,14 @@ void EncoderMotor::enableInterruptOnBothEdges(uint8_t aIntPinNumber) {
 
 void EncoderMotor::updateAllMotors() {
     EncoderMotor * tEncoderMotorControlPointer = sMotorControlListStart;
+    updateMotorInfoStorage();
+    startBatchUpdate();
 // walk through list
     while (tEncoderMotorControlPointer != NULL) {
         tEncoderMotorControlPointer->updateMotor();
         tEncoderMotorControlPointer = tEncoderMotorControlPointer->NextMotorControl;
     }
+    endBatchUpdate();
 }
 
 void EncoderMotor::setDirectionForAll(bool goForward) {
@@ -27,6 +27,15 @@
 #define DEFAULT_STOP_SPEED  50
 #define DEFAULT_MAX_SPEED   80
 
+/*
+ * Start value for calibrate(). With ultrasonic PWM frequency, motors start at lower values.
+ */
+#ifdef USE_TB6612_HIGH_FREQUENCY_PWM
+#define CALIBRATE_START_SPEED 5
+#else
+#define CALIBRATE_START_SPEED 20
+#endif
+
 /*
  * Motor Control
  */
@@ -65,6 +74,29 @@ struct EepromMotorInfoStruct {
     uint8_t SpeedCompensation;
 };
 
+/*
+ * Stop model. The overshoot after the target count is reached is learned as function of the speed at start of ramp down
+ * and of the supply voltage. Ramp down and target count are moved forward by the predicted overshoot.
+ * The table is linearly interpolated between the centers of the speed bins.
+ */
+#define STOP_MODEL_SPEED_BINS 4
+#define STOP_MODEL_SPEED_BIN_SHIFT 6 // 64 speed units per bin
+#define STOP_MODEL_VOLTAGE_BINS 3
+#define STOP_MODEL_LOW_DECI_VOLT 60 // below is USB supply
+#define STOP_MODEL_HIGH_DECI_VOLT 75
+#define STOP_MODEL_FRACTION 4 // overshoot is stored in 1/4 count
+#define STOP_MODEL_INVALID 0xFF // value of erased EEPROM
+// a greater overshoot is not learned, the car was pushed or lifted
+#define STOP_MODEL_MAX_OVERSHOOT_COUNT 40
+// the new value has the weight 1 / 2^STOP_MODEL_LEARN_SHIFT
+#define STOP_MODEL_LEARN_SHIFT 2
+// the wheels are at rest if there was no encoder tick for this time after the motor has stopped
+#define STOP_MODEL_REST_MILLIS 200
+
+struct EepromStopModelStruct {
+    uint8_t Overshoot[STOP_MODEL_VOLTAGE_BINS][STOP_MODEL_SPEED_BINS];
+};
+
 class EncoderMotor: TB6612DcMotor {
 public:
 
@@ -84,6 +116,10 @@ public:
      */
     void setSpeedCompensated(uint8_t aRequestedSpeed);
     void setDirection(bool goForward);
+    /*
+     * Change max speed of a running motor without changing its target count
+     */
+    void changeMaxSpeed(uint8_t aMaxSpeed);
 
     /*
      * Sets speed to 0 and activate motor control for the appropriate direction
@@ -107,11 +143,20 @@ public:
      */
     static void calibrate();
     /*
-     * Read and store calibration and other control values (maxSpeed, SpeedCompensation) from/to EEPROM
+     * Read and store calibration and other control values (maxSpeed, SpeedCompensation) from/to EEPROM.
+     * Storing is done by MotorInfoStorage without blocking.
      */
     void readEeprom();
     void writeEeprom();
 
+    /*
+     * Stop model
+     */
+    static uint8_t getStopModelVoltageIndex();
+    bool getStopModelOvershoot(uint8_t aSpeed, uint8_t * aOvershootCount);
+    void learnStopModel();
+    bool learnStopModelAtRest();
+
     /*
      * Encoder interrupt handling
      */
@@ -168,6 +213,17 @@ public:
     // actually SpeedCompensation is in steps of 2 and only one motor can have a positive value, the other has zero.
     uint8_t SpeedCompensation;
 
+    /*
+     * Odometer of this wheel. Incremented for forward and decremented for backward ticks. Is never reset.
+     */
+    volatile int16_t EncoderPosition;
+
+    // Overshoot in 1/STOP_MODEL_FRACTION count. Is not reset.
+    uint8_t StopModel[STOP_MODEL_VOLTAGE_BINS][STOP_MODEL_SPEED_BINS];
+    bool StopModelHasChanged;
+    // set by the application, 0 if not known
+    static uint8_t SupplyDeciVolt;
+
     /*
      * Reset() resets all members from ActualSpeed to (including) Debug to 0
      */
@@ -204,6 +260,10 @@ public:
     uint8_t DistanceCountAfterRampUp;
     uint16_t DebugCount;
     uint8_t SpeedAtTargetCountReached;
+    // 0 if the last stop was not at the target count
+    uint8_t SpeedAtRampDownStart;
+    // target count after the correction by the stop model
+    uint16_t StopModelTargetCount;
 
     // do not delete it!!! It must be the last element in structure and is needed for resetAndStop()
     uint16_t Debug;
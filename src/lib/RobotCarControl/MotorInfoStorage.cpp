@@ -0,0 +1,172 @@
+/*
+ * MotorInfoStorage.cpp
+ *
+ * The values of both motors are stored as one record with write count and checksum in a ring of MOTOR_INFO_RING_SLOTS slots.
+ * Each commit writes the next slot, the valid record with the greatest write count is the newest. A record torn by a reset
+ * has a wrong checksum, so the previous record is taken at the next start.
+ *
+ * Changes are only marked and committed later. A commit writes one byte per call of updateMotorInfoStorage(),
+ * and only if the EEPROM is ready, so it never waits the 3.3 ms of a write cycle.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <stddef.h>
+
+#include <MotorInfoStorage.h>
+#include <CarMotorControl.h>
+
+#define MOTOR_INFO_NO_SLOT 0xFF
+#define MOTOR_INFO_NO_COMMIT 0xFF
+#define MOTOR_INFO_ERASED_WRITE_COUNT 0xFFFF
+#define MOTOR_INFO_CHECKSUM_SEED 0xA5
+
+uint16_t sMotorInfoWriteCount = 0;
+
+// the newest record or the record of the running commit
+MotorInfoRecordStruct sMotorInfoRecord;
+bool sMotorInfoRingWasScanned = false;
+uint8_t sMotorInfoNewestSlot = MOTOR_INFO_NO_SLOT;
+
+bool sMotorInfoHasChanged = false;
+bool sMotorInfoCommitIsRequested = false;
+unsigned long sMotorInfoLastChangeMillis;
+unsigned long sMotorInfoLastCommitMillis;
+uint8_t sMotorInfoCommitSlot;
+uint8_t sMotorInfoCommitByteIndex = MOTOR_INFO_NO_COMMIT;
+
+uint8_t * getMotorInfoSlotAddress(uint8_t aSlot) {
+    return (uint8_t *) (EEPROM_MOTOR_INFO_RING_ADDRESS + (aSlot * sizeof(MotorInfoRecordStruct)));
+}
+
+/*
+ * Rotate and xor, so swapped bytes are detected too. The seed makes a record of only 0x00 invalid.
+ */
+uint8_t computeMotorInfoChecksum(MotorInfoRecordStruct * aRecord) {
+    uint8_t tChecksum = MOTOR_INFO_CHECKSUM_SEED;
+    uint8_t * tBytePointer = (uint8_t *) aRecord;
+    for (uint8_t i = 0; i < offsetof(MotorInfoRecordStruct, Checksum); ++i) {
+        tChecksum = ((tChecksum << 1) | (tChecksum >> 7)) ^ *tBytePointer++;
+    }
+    return tChecksum;
+}
+
+/*
+ * Erased slots have the write count 0xFFFF, which is never written.
+ * The write counts are compared modulo 2^16 to survive the overflow.
+ */
+void scanMotorInfoRing() {
+    sMotorInfoRingWasScanned = true;
+    MotorInfoRecordStruct tRecord;
+    for (uint8_t tSlot = 0; tSlot < MOTOR_INFO_RING_SLOTS; ++tSlot) {
+        eeprom_read_block((void*) &tRecord, (void*) getMotorInfoSlotAddress(tSlot), sizeof(MotorInfoRecordStruct));
+        if (tRecord.WriteCount == MOTOR_INFO_ERASED_WRITE_COUNT || tRecord.Checksum != computeMotorInfoChecksum(&tRecord)) {
+            continue;
+        }
+        if (sMotorInfoNewestSlot == MOTOR_INFO_NO_SLOT || (int16_t) (tRecord.WriteCount - sMotorInfoWriteCount) > 0) {
+            sMotorInfoNewestSlot = tSlot;
+            sMotorInfoWriteCount = tRecord.WriteCount;
+            sMotorInfoRecord = tRecord;
+        }
+    }
+}
+
+/*
+ * Returns false if the ring contains no valid record
+ */
+bool readMotorInfo(uint8_t aMotorNumber, EepromMotorInfoStruct * aMotorInfo) {
+    if (!sMotorInfoRingWasScanned) {
+        scanMotorInfoRing();
+    }
+    if (sMotorInfoNewestSlot == MOTOR_INFO_NO_SLOT || aMotorNumber >= MOTOR_INFO_NUMBER_OF_MOTORS) {
+        return false;
+    }
+    *aMotorInfo = sMotorInfoRecord.MotorInfo[aMotorNumber];
+    return true;
+}
+
+void markMotorInfoChanged() {
+    sMotorInfoHasChanged = true;
+    sMotorInfoLastChangeMillis = millis();
+}
+
+/*
+ * Commit without waiting for stop, idle or the minimum interval, e.g. after calibration
+ */
+void requestMotorInfoCommit() {
+    markMotorInfoChanged();
+    sMotorInfoCommitIsRequested = true;
+}
+
+/*
+ * Takes the values of all motors, so changes during the commit are marked again and go to the next commit
+ */
+void startMotorInfoCommit() {
+    if (!sMotorInfoRingWasScanned) {
+        scanMotorInfoRing();
+    }
+    sMotorInfoHasChanged = false;
+    sMotorInfoCommitIsRequested = false;
+
+    EncoderMotor * tEncoderMotorControlPointer = EncoderMotor::sMotorControlListStart;
+    while (tEncoderMotorControlPointer != NULL) {
+        if (tEncoderMotorControlPointer->EncoderMotorNumber < MOTOR_INFO_NUMBER_OF_MOTORS) {
+            EepromMotorInfoStruct * tMotorInfo = &sMotorInfoRecord.MotorInfo[tEncoderMotorControlPointer->EncoderMotorNumber];
+            tMotorInfo->MinSpeed = tEncoderMotorControlPointer->MinSpeed;
+            tMotorInfo->StopSpeed = tEncoderMotorControlPointer->StopSpeed;
+            tMotorInfo->MaxSpeed = tEncoderMotorControlPointer->MaxSpeed;
+            tMotorInfo->SpeedCompensation = tEncoderMotorControlPointer->SpeedCompensation;
+        }
+        tEncoderMotorControlPointer = tEncoderMotorControlPointer->NextMotorControl;
+    }
+
+    sMotorInfoRecord.WriteCount = sMotorInfoWriteCount + 1;
+    if (sMotorInfoRecord.WriteCount == MOTOR_INFO_ERASED_WRITE_COUNT) {
+        sMotorInfoRecord.WriteCount = 0;
+    }
+    sMotorInfoRecord.Checksum = computeMotorInfoChecksum(&sMotorInfoRecord);
+
+    sMotorInfoCommitSlot = 0;
+    if (sMotorInfoNewestSlot != MOTOR_INFO_NO_SLOT) {
+        sMotorInfoCommitSlot = (sMotorInfoNewestSlot + 1) % MOTOR_INFO_RING_SLOTS;
+    }
+    sMotorInfoCommitByteIndex = 0;
+}
+
+/*
+ * To be called regularly, e.g. by updateMotors(). Starts a commit if values have changed and the car is stopped
+ * or the values are unchanged for MOTOR_INFO_IDLE_MILLIS, and writes the next byte of a running commit.
+ */
+void updateMotorInfoStorage() {
+    if (sMotorInfoCommitByteIndex == MOTOR_INFO_NO_COMMIT) {
+        if (!sMotorInfoHasChanged) {
+            return;
+        }
+        if (!sMotorInfoCommitIsRequested) {
+            unsigned long tMillis = millis();
+            if (tMillis - sMotorInfoLastCommitMillis < MOTOR_INFO_MIN_COMMIT_INTERVAL_MILLIS) {
+                return;
+            }
+            if (!EncoderMotor::allMotorsStopped() && tMillis - sMotorInfoLastChangeMillis < MOTOR_INFO_IDLE_MILLIS) {
+                return;
+            }
+        }
+        startMotorInfoCommit();
+    }
+
+    if (!eeprom_is_ready()) {
+        return;
+    }
+    // unchanged bytes are not written
+    eeprom_update_byte(getMotorInfoSlotAddress(sMotorInfoCommitSlot) + sMotorInfoCommitByteIndex,
+            ((uint8_t *) &sMotorInfoRecord)[sMotorInfoCommitByteIndex]);
+    sMotorInfoCommitByteIndex++;
+    if (sMotorInfoCommitByteIndex >= sizeof(MotorInfoRecordStruct)) {
+        sMotorInfoCommitByteIndex = MOTOR_INFO_NO_COMMIT;
+        sMotorInfoNewestSlot = sMotorInfoCommitSlot;
+        sMotorInfoWriteCount = sMotorInfoRecord.WriteCount;
+        sMotorInfoLastCommitMillis = millis();
+    }
+}
@@ -0,0 +1,40 @@
+/*
+ * MotorInfoStorage.h
+ *
+ *  Lazy and wear levelled EEPROM storage of the EepromMotorInfoStruct of both motors.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef MOTORINFOSTORAGE_H_
+#define MOTORINFOSTORAGE_H_
+
+#include <stdint.h>
+#include <EncoderMotor.h>
+
+#define MOTOR_INFO_NUMBER_OF_MOTORS 2
+// 16 records of 11 bytes. Each commit goes to the next slot, so each slot is written only every 16th commit.
+#define MOTOR_INFO_RING_SLOTS 16
+
+/*
+ * Commit policy. A changed value is committed if the car is stopped or the values did not change for
+ * MOTOR_INFO_IDLE_MILLIS, but not more often than every MOTOR_INFO_MIN_COMMIT_INTERVAL_MILLIS.
+ * A commit requested by requestMotorInfoCommit() starts at the next poll.
+ */
+#define MOTOR_INFO_IDLE_MILLIS 2000
+#define MOTOR_INFO_MIN_COMMIT_INTERVAL_MILLIS 30000
+
+struct MotorInfoRecordStruct {
+    uint16_t WriteCount; // number of the commit, the greatest is the newest
+    EepromMotorInfoStruct MotorInfo[MOTOR_INFO_NUMBER_OF_MOTORS];
+    uint8_t Checksum;
+};
+
+extern uint16_t sMotorInfoWriteCount; // of the newest record in EEPROM, 0 if no record was found
+
+bool readMotorInfo(uint8_t aMotorNumber, EepromMotorInfoStruct * aMotorInfo);
+void markMotorInfoChanged();
+void requestMotorInfoCommit();
+void updateMotorInfoStorage();
+
+#endif /* MOTORINFOSTORAGE_H_ */
@@ -8,6 +8,9 @@
 #include <Arduino.h>
 
 #include <TB6612DcMotor.h>
+#ifdef USE_TB6612_BREAKOUT_BOARD
+#include <TB6612DcMotorFast.h>
+#endif
 
 #ifndef USE_TB6612_BREAKOUT_BOARD
 // Create the motor shield object with the default I2C address
@@ -23,6 +26,7 @@ TB6612DcMotor::TB6612DcMotor(uint8_t aForwardPin, uint8_t aBackwardPin, uint8_t
     ForwardPin = aForwardPin;
     BackwardPin = aBackwardPin;
     PWMPin = aPWMPin;
+    FastMotorNumber = -1;
     pinMode(aForwardPin, OUTPUT);
     pinMode(aBackwardPin, OUTPUT);
     pinMode(aPWMPin, OUTPUT);
@@ -34,14 +38,23 @@ TB6612DcMotor::TB6612DcMotor(uint8_t aForwardPin, uint8_t aBackwardPin, uint8_t
  */
 void TB6612DcMotor::init(uint8_t aMotorNumber) {
 #ifdef USE_TB6612_BREAKOUT_BOARD
+    FastMotorNumber = -1;
     if (aMotorNumber == 0) {
         ForwardPin = MOTOR_0_FORWARD_PIN;
         BackwardPin = MOTOR_0_BACKWARD_PIN;
         PWMPin = MOTOR_0_PWM_PIN;
+#ifndef USE_TB6612_RUNTIME_PINS
+        FastMotorNumber = 0;
+        TB6612Motor0Fast::init();
+#endif
     } else {
         ForwardPin = MOTOR_1_FORWARD_PIN;
         BackwardPin = MOTOR_1_BACKWARD_PIN;
         PWMPin = MOTOR_1_PWM_PIN;
+#ifndef USE_TB6612_RUNTIME_PINS
+        FastMotorNumber = 1;
+        TB6612Motor1Fast::init();
+#endif
     }
     pinMode(ForwardPin, OUTPUT);
     pinMode(BackwardPin, OUTPUT);
@@ -58,6 +71,15 @@ void TB6612DcMotor::init(uint8_t aMotorNumber) {
  */
 void TB6612DcMotor::run(uint8_t cmd) {
 #ifdef USE_TB6612_BREAKOUT_BOARD
+#ifndef USE_TB6612_RUNTIME_PINS
+    if (FastMotorNumber == 0) {
+        TB6612Motor0Fast::run(cmd);
+        return;
+    } else if (FastMotorNumber == 1) {
+        TB6612Motor1Fast::run(cmd);
+        return;
+    }
+#endif
     switch (cmd) {
         case FORWARD:
         digitalWrite(BackwardPin, LOW); // take low first to avoid 'break'
@@ -84,6 +106,15 @@ void TB6612DcMotor::run(uint8_t cmd) {
 
 void TB6612DcMotor::forward(uint8_t aSpeed) {
 #ifdef USE_TB6612_BREAKOUT_BOARD
+#ifndef USE_TB6612_RUNTIME_PINS
+    if (FastMotorNumber == 0) {
+        TB6612Motor0Fast::forward(aSpeed);
+        return;
+    } else if (FastMotorNumber == 1) {
+        TB6612Motor1Fast::forward(aSpeed);
+        return;
+    }
+#endif
     digitalWrite(ForwardPin, HIGH);
     digitalWrite(BackwardPin, LOW);
     analogWrite(PWMPin, aSpeed);
@@ -95,6 +126,15 @@ void TB6612DcMotor::forward(uint8_t aSpeed) {
 
 void TB6612DcMotor::backward(uint8_t aSpeed) {
 #ifdef USE_TB6612_BREAKOUT_BOARD
+#ifndef USE_TB6612_RUNTIME_PINS
+    if (FastMotorNumber == 0) {
+        TB6612Motor0Fast::backward(aSpeed);
+        return;
+    } else if (FastMotorNumber == 1) {
+        TB6612Motor1Fast::backward(aSpeed);
+        return;
+    }
+#endif
     digitalWrite(ForwardPin, LOW);
     digitalWrite(BackwardPin, HIGH);
     analogWrite(PWMPin, aSpeed);
@@ -106,6 +146,15 @@ void TB6612DcMotor::backward(uint8_t aSpeed) {
 
 void TB6612DcMotor::brake() {
 #ifdef USE_TB6612_BREAKOUT_BOARD
+#ifndef USE_TB6612_RUNTIME_PINS
+    if (FastMotorNumber == 0) {
+        TB6612Motor0Fast::brake();
+        return;
+    } else if (FastMotorNumber == 1) {
+        TB6612Motor1Fast::brake();
+        return;
+    }
+#endif
     digitalWrite(ForwardPin, HIGH);
     digitalWrite(BackwardPin, HIGH);
     analogWrite(PWMPin, 0);
@@ -117,6 +166,15 @@ void TB6612DcMotor::brake() {
 
 void TB6612DcMotor::release() {
 #ifdef USE_TB6612_BREAKOUT_BOARD
+#ifndef USE_TB6612_RUNTIME_PINS
+    if (FastMotorNumber == 0) {
+        TB6612Motor0Fast::release();
+        return;
+    } else if (FastMotorNumber == 1) {
+        TB6612Motor1Fast::release();
+        return;
+    }
+#endif
     digitalWrite(ForwardPin, HIGH);
     digitalWrite(BackwardPin, HIGH);
     analogWrite(PWMPin, 0);
@@ -132,8 +190,33 @@ void TB6612DcMotor::release() {
  */
 void TB6612DcMotor::setSpeed(uint8_t aSpeed) {
 #ifdef USE_TB6612_BREAKOUT_BOARD
+#ifndef USE_TB6612_RUNTIME_PINS
+    if (FastMotorNumber == 0) {
+        TB6612Motor0Fast::setSpeed(aSpeed);
+        return;
+    } else if (FastMotorNumber == 1) {
+        TB6612Motor1Fast::setSpeed(aSpeed);
+        return;
+    }
+#endif
     analogWrite(PWMPin, aSpeed);
 #else
     Adafruit_MotorShield_DcMotor->setSpeed(aSpeed);
 #endif
 }
+
+/*
+ * For the Adafruit shield, all following run() and setSpeed() calls only update the shadow registers.
+ * endBatchUpdate() sends the changed channels of both motors (PCA9685 channels 8 to 13) in one I2C transaction.
+ */
+void TB6612DcMotor::startBatchUpdate() {
+#ifndef USE_TB6612_BREAKOUT_BOARD
+    sAdafruitMotorShield.startBatchUpdate();
+#endif
+}
+
+void TB6612DcMotor::endBatchUpdate() {
+#ifndef USE_TB6612_BREAKOUT_BOARD
+    sAdafruitMotorShield.endBatchUpdate();
+#endif
+}
@@ -12,6 +12,11 @@
 
 // uncomment this for building version without adafruit motor shield
 //#define USE_TB6612_BREAKOUT_BOARD
+/*
+ * For the breakout board and the default pins, the compile time pin version TB6612DcMotorFast is used.
+ * Uncomment this to use always digitalWrite() and analogWrite() with the pins stored in the object.
+ */
+//#define USE_TB6612_RUNTIME_PINS
 #ifdef USE_TB6612_BREAKOUT_BOARD
 #define FORWARD 1
 #define BACKWARD 2
@@ -21,18 +26,34 @@
 #include <Adafruit_MotorShield.h>
 #endif
 
+/*
+ * Use a dedicated timer for ultrasonic (> 20 kHz) motor PWM instead of the 976 Hz of analogWrite() on timer0.
+ * This avoids the audible noise and gives more torque at low speed, so calibrate() finds a lower MinSpeed.
+ * ATmega2560 only: Timer3 (pin 5) and Timer4 (pin 6) at 20 kHz with 800 steps. No rewiring needed.
+ * ATmega328 is not supported. Timer0 is used for millis() and Timer1 by the Servo library, and the only free Timer2
+ * needs pin 3 as second output, which is INT1 of the left encoder. There is no other external interrupt pin.
+ * Only supported by the TB6612DcMotorFast backend.
+ */
+//#define USE_TB6612_HIGH_FREQUENCY_PWM
+#if defined(USE_TB6612_HIGH_FREQUENCY_PWM) && defined(USE_TB6612_RUNTIME_PINS)
+#error "USE_TB6612_HIGH_FREQUENCY_PWM requires the TB6612DcMotorFast backend, so do not define USE_TB6612_RUNTIME_PINS"
+#endif
+
 /*
  * Pins 9 + 10 are used for Servo library
  * 3 is used for encoder input
  */
-
+#ifndef MOTOR_0_FORWARD_PIN
 #define MOTOR_0_FORWARD_PIN 4
 #define MOTOR_0_BACKWARD_PIN 7
 #define MOTOR_0_PWM_PIN 5 // PWM capable
+#endif
 
+#ifndef MOTOR_1_FORWARD_PIN
 #define MOTOR_1_FORWARD_PIN 8
 #define MOTOR_1_BACKWARD_PIN 12
 #define MOTOR_1_PWM_PIN 6 // PWM capable
+#endif
 
 class TB6612DcMotor {
 public:
@@ -50,12 +71,20 @@ public:
     void release();
     void setSpeed(uint8_t aSpeed);
 
+    /*
+     * Collect the commands for all motors and send them at once. No-op for TB6612 breakout board.
+     */
+    static void startBatchUpdate();
+    static void endBatchUpdate();
+
 #ifndef USE_TB6612_BREAKOUT_BOARD
     Adafruit_DCMotor * Adafruit_MotorShield_DcMotor;
 #else
     uint8_t PWMPin;     // so set speed
     uint8_t ForwardPin; // if high, motor runs forward
     uint8_t BackwardPin;
+    // 0 or 1 if default pins are used -> use TB6612DcMotorFast, -1 -> use runtime pins above
+    int8_t FastMotorNumber;
 #endif
 
 };
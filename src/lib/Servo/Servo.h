@@ -79,6 +79,17 @@
 
 #define INVALID_SERVO         255     // flag indicating an invalid servo index
 
+// Default motion model for a SG90. Like the former fixed delay of 7 ms per degree, since for the 20 degree steps of a sweep
+// factor 8 gives a fairly reproducible result, factor 4 is a bit too fast. The real values can be learned by a calibration.
+#define DEFAULT_MICROS_PER_DEGREE    7000  // time the servo needs to move one degree
+#define DEFAULT_SETTLE_MILLIS           0  // additional time for accelerating and settling at the target
+
+// The AVR ISR sets the pins by the port register and bit mask stored at attach() instead of calling digitalWrite().
+// Define this to get the old digitalWrite() behavior e.g. for comparing the ISR duration.
+//#define SERVO_USE_DIGITAL_WRITE
+// Record the maximum duration of the AVR servo ISR (without entry and exit code). See Servo::getMaxISRMicros().
+//#define MEASURE_SERVO_ISR_DURATION
+
 typedef struct  {
   uint8_t nbr        :6 ;             // a pin number from 0 to 63
   uint8_t isActive   :1 ;             // true if this channel is enabled, pin not pulsed if false 
@@ -87,6 +98,10 @@ typedef struct  {
 typedef struct {
   ServoPin_t Pin;
   volatile unsigned int ticks;
+#if defined(ARDUINO_ARCH_AVR) && !defined(SERVO_USE_DIGITAL_WRITE)
+  volatile uint8_t *outputRegister;   // port output register of pin, set at attach()
+  uint8_t bitMask;                    // bit of pin in outputRegister
+#endif
 } servo_t;
 
 class Servo
@@ -101,10 +116,23 @@ public:
   int read();                        // returns current pulse width as an angle between 0 and 180 degrees
   int readMicroseconds();            // returns current pulse width in microseconds for this servo (was read_us() in first release)
   bool attached();                   // return true if this servo is attached, otherwise false 
+  void setMotionModel(unsigned int aMicrosPerDegree, uint8_t aSettleMillis); // speed and settle time, e.g. from a calibration
+  uint8_t getEstimatedAngle();       // returns the angle the servo is estimated to have now, based on the motion model
+  bool isSettled();                  // returns true if the servo is estimated to have reached and settled at the last written position
+  unsigned int getMillisUntilSettled(); // returns 0 if settled
+  unsigned int microsPerDegree;      // motion model
+  uint8_t settleMillis;
+#if defined(ARDUINO_ARCH_AVR) && defined(MEASURE_SERVO_ISR_DURATION)
+  static unsigned int getMaxISRMicros(); // returns the longest servo ISR duration measured so far
+  static void resetMaxISRMicros();
+#endif
 private:
    uint8_t servoIndex;               // index into the channel data for this servo
    int8_t min;                       // minimum is this value times 4 added to MIN_PULSE_WIDTH    
    int8_t max;                       // maximum is this value times 4 added to MAX_PULSE_WIDTH   
+   uint8_t modelStartAngle;          // estimated angle at the last write
+   uint8_t modelTargetAngle;         // angle of the last write
+   unsigned long modelStartMillis;   // millis() of the last write
 };
 
 #endif
@@ -37,6 +37,10 @@ static volatile int8_t Channel[_Nbr_16timers ];             // counter for the s
 
 uint8_t ServoCount = 0;                                     // the total number of attached servos
 
+#if defined(MEASURE_SERVO_ISR_DURATION)
+static volatile uint16_t ServoISRMaxTicks = 0;              // longest ISR duration in timer ticks
+#endif
+
 
 // convenience macros
 #define SERVO_INDEX_TO_TIMER(_servo_nbr) ((timer16_Sequence_t)(_servo_nbr / SERVOS_PER_TIMER)) // returns the timer controlling this servo
@@ -49,20 +53,36 @@ uint8_t ServoCount = 0;                                     // the total number
 
 /************ static functions common to all instances ***********************/
 
+#if defined(SERVO_USE_DIGITAL_WRITE)
+#define SERVO_PIN_LOW(_servo)  digitalWrite((_servo).Pin.nbr, LOW)
+#define SERVO_PIN_HIGH(_servo) digitalWrite((_servo).Pin.nbr, HIGH)
+#else
+// ISRs are not interrupted, so the read-modify-write of the port register is atomic here
+#define SERVO_PIN_LOW(_servo)  (*(_servo).outputRegister &= ~(_servo).bitMask)
+#define SERVO_PIN_HIGH(_servo) (*(_servo).outputRegister |= (_servo).bitMask)
+#endif
+
 static inline void handle_interrupts(timer16_Sequence_t timer, volatile uint16_t *TCNTn, volatile uint16_t* OCRnA)
 {
-  if( Channel[timer] < 0 )
+#if defined(MEASURE_SERVO_ISR_DURATION)
+  uint16_t tStartTicks = *TCNTn;
+#endif
+  if( Channel[timer] < 0 ) {
     *TCNTn = 0; // channel set to -1 indicated that refresh interval completed so reset the timer
+#if defined(MEASURE_SERVO_ISR_DURATION)
+    tStartTicks = 0; // loses the few ticks before the reset
+#endif
+  }
   else{
     if( SERVO_INDEX(timer,Channel[timer]) < ServoCount && SERVO(timer,Channel[timer]).Pin.isActive == true )
-      digitalWrite( SERVO(timer,Channel[timer]).Pin.nbr,LOW); // pulse this channel low if activated
+      SERVO_PIN_LOW(SERVO(timer,Channel[timer])); // pulse this channel low if activated
   }
 
   Channel[timer]++;    // increment to the next channel
   if( SERVO_INDEX(timer,Channel[timer]) < ServoCount && Channel[timer] < SERVOS_PER_TIMER) {
     *OCRnA = *TCNTn + SERVO(timer,Channel[timer]).ticks;
     if(SERVO(timer,Channel[timer]).Pin.isActive == true)     // check if activated
-      digitalWrite( SERVO(timer,Channel[timer]).Pin.nbr,HIGH); // its an active channel so pulse it high
+      SERVO_PIN_HIGH(SERVO(timer,Channel[timer])); // its an active channel so pulse it high
   }
   else {
     // finished all channels so wait for the refresh period to expire before starting over
@@ -72,6 +92,11 @@ static inline void handle_interrupts(timer16_Sequence_t timer, volatile uint16_t
       *OCRnA = *TCNTn + 4;  // at least REFRESH_INTERVAL has elapsed
     Channel[timer] = -1; // this will get incremented at the end of the refresh period to start again at the first channel
   }
+#if defined(MEASURE_SERVO_ISR_DURATION)
+  uint16_t tDurationTicks = *TCNTn - tStartTicks;
+  if (tDurationTicks > ServoISRMaxTicks)
+    ServoISRMaxTicks = tDurationTicks;
+#endif
 }
 
 #ifndef WIRING // Wiring pre-defines signal handlers so don't define any if compiling for the Wiring platform
@@ -227,6 +252,11 @@ Servo::Servo()
   }
   else
     this->servoIndex = INVALID_SERVO ;  // too many servos
+  this->microsPerDegree = DEFAULT_MICROS_PER_DEGREE;
+  this->settleMillis = DEFAULT_SETTLE_MILLIS;
+  this->modelStartAngle = 90;
+  this->modelTargetAngle = 90;
+  this->modelStartMillis = 0;
 }
 
 uint8_t Servo::attach(int pin)
@@ -239,6 +269,12 @@ uint8_t Servo::attach(int pin, int min, int max)
   if(this->servoIndex < MAX_SERVOS ) {
     pinMode( pin, OUTPUT) ;                                   // set servo pin to output
     servos[this->servoIndex].Pin.nbr = pin;
+#if !defined(SERVO_USE_DIGITAL_WRITE)
+    // digitalWrite() would also switch off a PWM timer output, so do it once here
+    digitalWrite(pin, LOW);
+    servos[this->servoIndex].outputRegister = portOutputRegister(digitalPinToPort(pin));
+    servos[this->servoIndex].bitMask = digitalPinToBitMask(pin);
+#endif
     // todo min/max check: abs(min - MIN_PULSE_WIDTH) /4 < 128
     this->min  = (MIN_PULSE_WIDTH - min)/4; //resolution of min/max is 4 uS
     this->max  = (MAX_PULSE_WIDTH - max)/4;
@@ -282,6 +318,14 @@ void Servo::writeMicroseconds(int value)
     else if( value > SERVO_MAX() )
       value = SERVO_MAX();
 
+    // the new move starts at the position the servo has now, which may be in the middle of the last move
+    uint8_t newTargetAngle = map(value, SERVO_MIN(), SERVO_MAX(), 0, 180);
+    if (newTargetAngle != this->modelTargetAngle) {
+      this->modelStartAngle = getEstimatedAngle();
+      this->modelTargetAngle = newTargetAngle;
+      this->modelStartMillis = millis();
+    }
+
     value = value - TRIM_DURATION;
     value = usToTicks(value);  // convert to ticks after compensating for interrupt overhead - 12 Aug 2009
 
@@ -313,5 +357,66 @@ bool Servo::attached()
   return servos[this->servoIndex].Pin.isActive ;
 }
 
+/*
+ * Motion model: the servo moves with constant speed from the start to the target angle and then needs settleMillis to settle.
+ */
+void Servo::setMotionModel(unsigned int aMicrosPerDegree, uint8_t aSettleMillis)
+{
+  this->microsPerDegree = aMicrosPerDegree;
+  this->settleMillis = aSettleMillis;
+}
+
+uint8_t Servo::getEstimatedAngle()
+{
+  uint8_t deltaAngle = abs(this->modelTargetAngle - this->modelStartAngle);
+  if (deltaAngle == 0 || this->microsPerDegree == 0) {
+    return this->modelTargetAngle;
+  }
+  unsigned long elapsedMillis = millis() - this->modelStartMillis;
+  if (elapsedMillis >= ((unsigned long) deltaAngle * this->microsPerDegree) / 1000) {
+    return this->modelTargetAngle;
+  }
+  uint8_t movedAngle = (elapsedMillis * 1000) / this->microsPerDegree;
+  if (this->modelTargetAngle > this->modelStartAngle) {
+    return this->modelStartAngle + movedAngle;
+  }
+  return this->modelStartAngle - movedAngle;
+}
+
+unsigned int Servo::getMillisUntilSettled()
+{
+  uint8_t deltaAngle = abs(this->modelTargetAngle - this->modelStartAngle);
+  unsigned long moveMillis = ((unsigned long) deltaAngle * this->microsPerDegree) / 1000 + this->settleMillis;
+  unsigned long elapsedMillis = millis() - this->modelStartMillis;
+  if (elapsedMillis >= moveMillis) {
+    return 0;
+  }
+  return moveMillis - elapsedMillis;
+}
+
+bool Servo::isSettled()
+{
+  return getMillisUntilSettled() == 0;
+}
+
+#if defined(MEASURE_SERVO_ISR_DURATION)
+unsigned int Servo::getMaxISRMicros()
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t tMaxTicks = ServoISRMaxTicks;
+  SREG = oldSREG;
+  return ticksToUs(tMaxTicks);
+}
+
+void Servo::resetMaxISRMicros()
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  ServoISRMaxTicks = 0;
+  SREG = oldSREG;
+}
+#endif
+
 #endif // ARDUINO_ARCH_AVR
 
@@ -82,7 +82,49 @@ void TwoWire::end(void)
 
 void TwoWire::setClock(uint32_t frequency)
 {
-  TWBR = ((F_CPU / frequency) - 16) / 2;
+  twi_setFrequency(frequency);
+}
+
+/***
+ * Sets the TWI timeout.
+ *
+ * This limits the maximum time to wait for the TWI hardware. If more time passes, the bus is assumed
+ * to have locked up (e.g. due to noise-induced glitches of the motors or a faulty slave) and the
+ * transaction is aborted. Optionally, the bus is recovered by clocking out the stuck slave and the
+ * TWI hardware is reinitialized.
+ *
+ * @param timeout a timeout value in microseconds, 0 disables the timeout
+ * @param reset_with_timeout if true then recover bus and reset TWI interface after a timeout
+ */
+void TwoWire::setWireTimeout(uint32_t timeout, bool reset_with_timeout)
+{
+  twi_setTimeoutInMicros(timeout, reset_with_timeout);
+}
+
+/***
+ * Returns the TWI timeout flag. It is set on a timeout and cleared by clearWireTimeoutFlag() or setWireTimeout().
+ */
+bool TwoWire::getWireTimeoutFlag(void)
+{
+  return(twi_manageTimeoutFlag(false));
+}
+
+void TwoWire::clearWireTimeoutFlag(void)
+{
+  twi_manageTimeoutFlag(true);
+}
+
+/***
+ * Number of timeouts and bus recoveries since power on
+ */
+uint16_t TwoWire::getWireTimeoutCount(void)
+{
+  return twi_getTimeoutCount();
+}
+
+uint16_t TwoWire::getWireRecoveryCount(void)
+{
+  return twi_getRecoveryCount();
 }
 
 uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint32_t iaddress, uint8_t isize, uint8_t sendStop)
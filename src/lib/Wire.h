@@ -30,6 +30,9 @@
 // WIRE_HAS_END means Wire has end()
 #define WIRE_HAS_END 1
 
+// WIRE_HAS_TIMEOUT means Wire has setWireTimeout(), getWireTimeoutFlag and clearWireTimeout()
+#define WIRE_HAS_TIMEOUT 1
+
 class TwoWire : public Stream
 {
   private:
@@ -54,6 +57,11 @@ class TwoWire : public Stream
     void begin(int);
     void end();
     void setClock(uint32_t);
+    void setWireTimeout(uint32_t timeout = 25000, bool reset_with_timeout = false);
+    bool getWireTimeoutFlag(void);
+    void clearWireTimeoutFlag(void);
+    uint16_t getWireTimeoutCount(void);
+    uint16_t getWireRecoveryCount(void);
     void beginTransmission(uint8_t);
     void beginTransmission(int);
     uint8_t endTransmission(void);
@@ -0,0 +1,34 @@
+/*
+ * Arduino.cpp
+ *
+ * Simulated time of the host build. The simulated MPU-6050 writes a sample of RawGyroZ to its FIFO
+ * every (SAMPLE_RATE_DIVIDER + 1) milliseconds, if the z gyroscope FIFO and the FIFO itself are enabled.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "Arduino.h"
+#include "Wire.h"
+
+#define REGISTER_SAMPLE_RATE_DIVIDER 0x19
+#define REGISTER_FIFO_ENABLE 0x23
+#define REGISTER_USER_CONTROL 0x6A
+#define FIFO_ENABLE_GYRO_Z 0x10
+#define USER_CONTROL_FIFO_ENABLE 0x40
+
+unsigned long sMillis;
+
+unsigned long millis() {
+    return sMillis;
+}
+
+void delay(unsigned long aMillis) {
+    for (unsigned long i = 0; i < aMillis; ++i) {
+        sMillis++;
+        uint8_t *tRegisters = sSimulatedMPU6050.Registers;
+        if ((tRegisters[REGISTER_FIFO_ENABLE] & FIFO_ENABLE_GYRO_Z) && (tRegisters[REGISTER_USER_CONTROL] & USER_CONTROL_FIFO_ENABLE)
+                && sMillis % (tRegisters[REGISTER_SAMPLE_RATE_DIVIDER] + 1) == 0) {
+            pushSimulatedMPU6050Sample(sSimulatedMPU6050.RawGyroZ);
+        }
+    }
+}
@@ -0,0 +1,22 @@
+/*
+ * Arduino.h
+ *
+ *  Host replacement of the few Arduino functions used by MPU6050.cpp.
+ *  delay() advances the simulated time, so the simulated MPU-6050 writes its samples to the FIFO.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+
+unsigned long millis();
+void delay(unsigned long aMillis);
+
+#endif // HOST_ARDUINO_H_
@@ -0,0 +1,172 @@
+/*
+ * MPU6050Test.cpp
+ *
+ * Host test of src/lib/MPU6050.cpp against the simulated MPU-6050 of Wire.cpp.
+ * Checks detection by WHO_AM_I, learning of the bias, integration of the yaw,
+ * reading of a partial final burst, the burst limit per update and the handling of a FIFO overflow.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <stdio.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "../../src/lib/MPU6050.h"
+
+extern long sIMUYawSum;
+
+int sFailedChecks = 0;
+
+#define CHECK_EQUAL(aActual, aExpected) checkEqual((long) (aActual), (long) (aExpected), #aActual, __LINE__)
+
+void checkEqual(long aActual, long aExpected, const char *aExpression, int aLine) {
+    if (aActual != aExpected) {
+        printf("Line %d: %s is %ld, expected %ld\n", aLine, aExpression, aActual, aExpected);
+        sFailedChecks++;
+    }
+}
+
+/*
+ * Connected and initialized simulated MPU-6050 with empty FIFO and without bias
+ */
+void setupIMU(int16_t aRawGyroZ) {
+    resetSimulatedMPU6050();
+    sSimulatedMPU6050.RawGyroZ = aRawGyroZ;
+    sIMUOverflowCount = 0;
+    sIMUBias16 = 0;
+    sIMUYawSum = 0;
+    CHECK_EQUAL(initIMU(), true);
+}
+
+void testWhoAmI() {
+    resetSimulatedMPU6050();
+    sSimulatedMPU6050.IsConnected = false;
+    CHECK_EQUAL(initIMU(), false);
+    CHECK_EQUAL(sIMUIsInitialized, false);
+    CHECK_EQUAL(updateIMU(false), 0);
+    CHECK_EQUAL(learnIMUBias(), false);
+
+    resetSimulatedMPU6050();
+    sSimulatedMPU6050.WhoAmI = 0x72;
+    CHECK_EQUAL(initIMU(), false);
+
+    resetSimulatedMPU6050();
+    CHECK_EQUAL(initIMU(), true);
+    CHECK_EQUAL(sIMUIsInitialized, true);
+    CHECK_EQUAL(sSimulatedMPU6050.Registers[MPU6050_REGISTER_FIFO_ENABLE], 0x10);
+    CHECK_EQUAL(sSimulatedMPU6050.Registers[MPU6050_REGISTER_SAMPLE_RATE_DIVIDER], 19);
+    CHECK_EQUAL(sSimulatedMPU6050.FifoCount, 0);
+}
+
+void testBias() {
+    setupIMU(-100);
+    CHECK_EQUAL(sIMUBiasIsValid, false);
+    CHECK_EQUAL(learnIMUBias(), true);
+    CHECK_EQUAL(sIMUBiasIsValid, true);
+    CHECK_EQUAL(sIMUBias16, -100 * 16);
+    // standstill samples are not integrated
+    CHECK_EQUAL(getIMUYawDelta16(), 0);
+
+    // samples while moving interrupt the bias sequence
+    setupIMU(50);
+    for (uint8_t i = 0; i < MPU6050_BIAS_SAMPLES - 1; ++i) {
+        pushSimulatedMPU6050Sample(50);
+    }
+    updateIMU(true);
+    pushSimulatedMPU6050Sample(50);
+    updateIMU(false);
+    pushSimulatedMPU6050Sample(50);
+    updateIMU(true);
+    CHECK_EQUAL(sIMUBiasIsValid, false);
+}
+
+void testYaw() {
+    setupIMU(20);
+    learnIMUBias();
+    // 1 degree per second to the left for 1 second at 50 samples per second
+    sSimulatedMPU6050.RawGyroZ = 20 + MPU6050_LSB_PER_DEGREE_PER_SECOND;
+    resetIMUFifo();
+    delay(1000);
+    CHECK_EQUAL(sSimulatedMPU6050.FifoCount, MPU6050_SAMPLE_RATE_HZ * 2);
+    CHECK_EQUAL(updateIMU(false), MPU6050_SAMPLE_RATE_HZ);
+    CHECK_EQUAL(sIMUYawRate16, 16);
+    CHECK_EQUAL(getIMUYawDelta16(), 16);
+
+    // 3 samples are 0.96/16 degree, the fraction is kept for the next call
+    for (uint8_t i = 0; i < 3; ++i) {
+        pushSimulatedMPU6050Sample(20 + MPU6050_LSB_PER_DEGREE_PER_SECOND);
+    }
+    updateIMU(false);
+    CHECK_EQUAL(getIMUYawDelta16(), 0);
+    pushSimulatedMPU6050Sample(20 + MPU6050_LSB_PER_DEGREE_PER_SECOND);
+    updateIMU(false);
+    CHECK_EQUAL(getIMUYawDelta16(), 1);
+
+    // to the right. The 0.28/16 degree left from above is kept, the fraction is truncated towards 0.
+    for (uint8_t i = 0; i < MPU6050_SAMPLE_RATE_HZ; ++i) {
+        pushSimulatedMPU6050Sample(20 - MPU6050_LSB_PER_DEGREE_PER_SECOND);
+    }
+    updateIMU(false);
+    CHECK_EQUAL(getIMUYawDelta16(), -15);
+    long tLeftFromAbove = (4 * 16L * MPU6050_LSB_PER_DEGREE_PER_SECOND) - MPU6050_YAW_SUM_PER_DEGREE16;
+    CHECK_EQUAL(sIMUYawSum,
+            tLeftFromAbove - (MPU6050_SAMPLE_RATE_HZ * 16L * MPU6050_LSB_PER_DEGREE_PER_SECOND) + (15 * MPU6050_YAW_SUM_PER_DEGREE16));
+}
+
+void testPartialBurst() {
+    setupIMU(0);
+    // 20 samples and the first byte of the next one => bursts of 16 and 4 samples
+    for (uint8_t i = 0; i < 20; ++i) {
+        pushSimulatedMPU6050Sample(MPU6050_LSB_PER_DEGREE_PER_SECOND);
+    }
+    pushSimulatedMPU6050Byte(0x00);
+    CHECK_EQUAL(updateIMU(false), 20);
+    CHECK_EQUAL(sSimulatedMPU6050.FifoCount, 1);
+    // the second byte completes the sample
+    pushSimulatedMPU6050Byte(MPU6050_LSB_PER_DEGREE_PER_SECOND);
+    CHECK_EQUAL(updateIMU(false), 1);
+    CHECK_EQUAL(sSimulatedMPU6050.FifoCount, 0);
+    CHECK_EQUAL(sIMUYawRate16, 16);
+
+    // not more than MPU6050_MAX_BURSTS_PER_UPDATE bursts per call
+    for (uint8_t i = 0; i < 70; ++i) {
+        pushSimulatedMPU6050Sample(0);
+    }
+    CHECK_EQUAL(updateIMU(false), MPU6050_MAX_BURSTS_PER_UPDATE * (BUFFER_LENGTH / 2));
+    CHECK_EQUAL(updateIMU(false), 70 - (MPU6050_MAX_BURSTS_PER_UPDATE * (BUFFER_LENGTH / 2)));
+    CHECK_EQUAL(sSimulatedMPU6050.FifoCount, 0);
+}
+
+void testOverflow() {
+    setupIMU(0);
+    uint16_t tResetCount = sSimulatedMPU6050.FifoResetCount;
+    for (uint16_t i = 0; i < (MPU6050_FIFO_SIZE / 2) + 10; ++i) {
+        pushSimulatedMPU6050Sample(MPU6050_LSB_PER_DEGREE_PER_SECOND);
+    }
+    CHECK_EQUAL(sSimulatedMPU6050.FifoCount, MPU6050_FIFO_SIZE);
+    CHECK_EQUAL(updateIMU(false), 0);
+    CHECK_EQUAL(sIMUOverflowCount, 1);
+    CHECK_EQUAL(sSimulatedMPU6050.FifoResetCount, tResetCount + 1);
+    CHECK_EQUAL(sSimulatedMPU6050.FifoCount, 0);
+    // the lost samples are not integrated
+    CHECK_EQUAL(getIMUYawDelta16(), 0);
+
+    // the FIFO is running again after the reset
+    delay(1000 / MPU6050_SAMPLE_RATE_HZ);
+    CHECK_EQUAL(updateIMU(false), 1);
+}
+
+int main() {
+    testWhoAmI();
+    testBias();
+    testYaw();
+    testPartialBurst();
+    testOverflow();
+    if (sFailedChecks != 0) {
+        printf("%d checks failed\n", sFailedChecks);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
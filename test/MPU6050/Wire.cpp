@@ -0,0 +1,146 @@
+/*
+ * Wire.cpp
+ *
+ * Simulated MPU-6050 on the I2C bus of the host build.
+ * A write transmission sets the register pointer with its first byte and writes the following bytes to the registers.
+ * A read returns at most BUFFER_LENGTH bytes from the register pointer. The pointer is incremented,
+ * except for the FIFO register, where each byte is taken from the FIFO.
+ * If the FIFO is full, the oldest bytes are overwritten and FIFO_COUNT stays at 1024, like the real chip does.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include <string.h>
+
+#include "Wire.h"
+
+#define SIMULATED_MPU6050_I2C_ADDRESS 0x68
+#define REGISTER_USER_CONTROL 0x6A
+#define REGISTER_FIFO_COUNT_HIGH 0x72
+#define REGISTER_FIFO_COUNT_LOW 0x73
+#define REGISTER_FIFO_READ_WRITE 0x74
+#define REGISTER_WHO_AM_I 0x75
+#define USER_CONTROL_FIFO_RESET 0x04
+
+TwoWire Wire;
+SimulatedMPU6050 sSimulatedMPU6050;
+
+uint8_t sTxAddress;
+uint8_t sTxBuffer[BUFFER_LENGTH];
+uint8_t sTxLength;
+uint8_t sRegisterPointer;
+uint8_t sRxBuffer[BUFFER_LENGTH];
+uint8_t sRxLength;
+uint8_t sRxIndex;
+
+void resetSimulatedMPU6050() {
+    memset(&sSimulatedMPU6050, 0, sizeof(sSimulatedMPU6050));
+    sSimulatedMPU6050.IsConnected = true;
+    sSimulatedMPU6050.WhoAmI = SIMULATED_MPU6050_I2C_ADDRESS;
+}
+
+void pushSimulatedMPU6050Byte(uint8_t aByte) {
+    if (sSimulatedMPU6050.FifoCount == SIMULATED_MPU6050_FIFO_SIZE) {
+        // overwrite the oldest byte
+        memmove(sSimulatedMPU6050.Fifo, sSimulatedMPU6050.Fifo + 1, SIMULATED_MPU6050_FIFO_SIZE - 1);
+        sSimulatedMPU6050.FifoCount--;
+    }
+    sSimulatedMPU6050.Fifo[sSimulatedMPU6050.FifoCount++] = aByte;
+}
+
+void pushSimulatedMPU6050Sample(int16_t aRawGyroZ) {
+    pushSimulatedMPU6050Byte((uint16_t) aRawGyroZ >> 8);
+    pushSimulatedMPU6050Byte(aRawGyroZ & 0xFF);
+}
+
+static bool isSimulatedMPU6050Addressed(uint8_t aAddress) {
+    return sSimulatedMPU6050.IsConnected && aAddress == SIMULATED_MPU6050_I2C_ADDRESS;
+}
+
+static void writeSimulatedMPU6050Register(uint8_t aRegister, uint8_t aValue) {
+    if (aRegister == REGISTER_USER_CONTROL && (aValue & USER_CONTROL_FIFO_RESET)) {
+        sSimulatedMPU6050.FifoCount = 0;
+        sSimulatedMPU6050.FifoResetCount++;
+        // the reset bit clears itself
+        aValue &= ~USER_CONTROL_FIFO_RESET;
+    }
+    sSimulatedMPU6050.Registers[aRegister & 0x7F] = aValue;
+}
+
+static uint8_t readSimulatedMPU6050Register(uint8_t aRegister) {
+    switch (aRegister) {
+    case REGISTER_FIFO_COUNT_HIGH:
+        return sSimulatedMPU6050.FifoCount >> 8;
+    case REGISTER_FIFO_COUNT_LOW:
+        return sSimulatedMPU6050.FifoCount & 0xFF;
+    case REGISTER_WHO_AM_I:
+        return sSimulatedMPU6050.WhoAmI;
+    case REGISTER_FIFO_READ_WRITE: {
+        if (sSimulatedMPU6050.FifoCount == 0) {
+            return 0xFF;
+        }
+        uint8_t tByte = sSimulatedMPU6050.Fifo[0];
+        sSimulatedMPU6050.FifoCount--;
+        memmove(sSimulatedMPU6050.Fifo, sSimulatedMPU6050.Fifo + 1, sSimulatedMPU6050.FifoCount);
+        return tByte;
+    }
+    default:
+        return sSimulatedMPU6050.Registers[aRegister & 0x7F];
+    }
+}
+
+void TwoWire::beginTransmission(uint8_t aAddress) {
+    sTxAddress = aAddress;
+    sTxLength = 0;
+}
+
+size_t TwoWire::write(uint8_t aData) {
+    if (sTxLength >= BUFFER_LENGTH) {
+        return 0;
+    }
+    sTxBuffer[sTxLength++] = aData;
+    return 1;
+}
+
+/*
+ * Returns 2 (address NACK) if no device answers
+ */
+uint8_t TwoWire::endTransmission(bool aSendStop) {
+    (void) aSendStop;
+    if (!isSimulatedMPU6050Addressed(sTxAddress)) {
+        return 2;
+    }
+    if (sTxLength > 0) {
+        sRegisterPointer = sTxBuffer[0];
+        for (uint8_t i = 1; i < sTxLength; ++i) {
+            writeSimulatedMPU6050Register(sRegisterPointer++, sTxBuffer[i]);
+        }
+    }
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t aAddress, uint8_t aQuantity) {
+    sRxLength = 0;
+    sRxIndex = 0;
+    if (!isSimulatedMPU6050Addressed(aAddress)) {
+        return 0;
+    }
+    if (aQuantity > BUFFER_LENGTH) {
+        aQuantity = BUFFER_LENGTH;
+    }
+    for (uint8_t i = 0; i < aQuantity; ++i) {
+        sRxBuffer[i] = readSimulatedMPU6050Register(sRegisterPointer);
+        if (sRegisterPointer != REGISTER_FIFO_READ_WRITE) {
+            sRegisterPointer++;
+        }
+    }
+    sRxLength = aQuantity;
+    return aQuantity;
+}
+
+int TwoWire::read() {
+    if (sRxIndex >= sRxLength) {
+        return -1;
+    }
+    return sRxBuffer[sRxIndex++];
+}
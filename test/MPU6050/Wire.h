@@ -0,0 +1,50 @@
+/*
+ * Wire.h
+ *
+ *  Host replacement of the Arduino Wire library with a simulated MPU-6050 at address 0x68.
+ *  The model has the registers used by MPU6050.cpp, a FIFO of 1024 bytes which stops at overflow,
+ *  the FIFO reset bit of USER_CTRL and the 32 byte receive buffer of the AVR Wire library.
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef HOST_WIRE_H_
+#define HOST_WIRE_H_
+
+#include <stdint.h>
+
+#define BUFFER_LENGTH 32
+
+class TwoWire {
+public:
+    void beginTransmission(uint8_t aAddress);
+    uint8_t endTransmission(bool aSendStop = true);
+    uint8_t requestFrom(uint8_t aAddress, uint8_t aQuantity);
+    size_t write(uint8_t aData);
+    int read();
+};
+
+extern TwoWire Wire;
+
+/*
+ * Control and inspection of the simulated MPU-6050
+ */
+#define SIMULATED_MPU6050_FIFO_SIZE 1024
+
+struct SimulatedMPU6050 {
+    bool IsConnected;
+    uint8_t WhoAmI;
+    uint8_t Registers[128];
+    uint8_t Fifo[SIMULATED_MPU6050_FIFO_SIZE];
+    uint16_t FifoCount;
+    uint16_t FifoResetCount;
+    int16_t RawGyroZ; // written to the FIFO at each sample if the FIFO is enabled
+};
+
+extern SimulatedMPU6050 sSimulatedMPU6050;
+
+void resetSimulatedMPU6050();
+void pushSimulatedMPU6050Sample(int16_t aRawGyroZ);
+void pushSimulatedMPU6050Byte(uint8_t aByte);
+
+#endif // HOST_WIRE_H_